@@ -33,6 +33,8 @@
 #include "globalconf.h"
 #include "objects/client.h"
 #include "objects/screen.h"
+#include "profile.h"
+#include "property.h"
 #include "spawn.h"
 #include "systray.h"
 #include "xwindow.h"
@@ -67,6 +69,12 @@ static struct timeval last_wakeup;
 /** current limit for the main loop's runtime */
 static float main_loop_iteration_limit = 0.1;
 
+/** profiling time of last main loop wakeup */
+static int64_t profile_wakeup;
+
+/** profiling time at which GLib started dispatching its sources */
+static int64_t profile_dispatch_start;
+
 /** Call before exiting.
  */
 void
@@ -305,43 +313,188 @@ static xcb_generic_event_t *poll_for_event(void)
     return xcb_poll_for_event(globalconf.connection);
 }
 
-static void
-a_xcb_check(void)
+DO_ARRAY(xcb_generic_event_t *, xcb_generic_event, DO_NOTHING)
+
+/** Hash function for events which can be folded into later ones.
+ * \param data The event.
+ * \return The hash of what identifies the event.
+ */
+static guint
+event_fold_hash(gconstpointer data)
 {
-    xcb_generic_event_t *mouse = NULL, *event;
+    const xcb_generic_event_t *event = data;
+    uint8_t type = XCB_EVENT_RESPONSE_TYPE(event);
 
-    while((event = poll_for_event()))
+    switch(type)
     {
-        /* We will treat mouse events later.
-         * We cannot afford to treat all mouse motion events,
-         * because that would be too much CPU intensive, so we just
-         * take the last we get after a bunch of events. */
-        if(XCB_EVENT_RESPONSE_TYPE(event) == XCB_MOTION_NOTIFY)
+      case XCB_PROPERTY_NOTIFY:
         {
-            p_delete(&mouse);
-            mouse = event;
+            const xcb_property_notify_event_t *ev = data;
+            return (ev->window * 31 + ev->atom) ^ type;
         }
-        else
+      case XCB_EXPOSE:
+        return ((const xcb_expose_event_t *) data)->window ^ type;
+      case XCB_CONFIGURE_NOTIFY:
+        {
+            const xcb_configure_notify_event_t *ev = data;
+            return (ev->event * 31 + ev->window) ^ type;
+        }
+    }
+    return type;
+}
+
+/** Check if two events are about the same thing, so that the later one
+ * supersedes the earlier one.
+ * \param a The first event.
+ * \param b The second event.
+ * \return True if the events can be folded into one.
+ */
+static gboolean
+event_fold_equal(gconstpointer a, gconstpointer b)
+{
+    uint8_t type = XCB_EVENT_RESPONSE_TYPE((const xcb_generic_event_t *) a);
+
+    if(type != XCB_EVENT_RESPONSE_TYPE((const xcb_generic_event_t *) b))
+        return FALSE;
+
+    switch(type)
+    {
+      case XCB_PROPERTY_NOTIFY:
         {
-            uint8_t type = XCB_EVENT_RESPONSE_TYPE(event);
-            if(mouse && (type == XCB_ENTER_NOTIFY || type == XCB_LEAVE_NOTIFY
-                        || type == XCB_BUTTON_PRESS || type == XCB_BUTTON_RELEASE))
+            const xcb_property_notify_event_t *x = a, *y = b;
+            return x->window == y->window && x->atom == y->atom;
+        }
+      case XCB_EXPOSE:
+        return ((const xcb_expose_event_t *) a)->window
+            == ((const xcb_expose_event_t *) b)->window;
+      case XCB_CONFIGURE_NOTIFY:
+        {
+            const xcb_configure_notify_event_t *x = a, *y = b;
+            return x->event == y->event && x->window == y->window;
+        }
+    }
+    return FALSE;
+}
+
+/** Merge the area of an expose event into a later one for the same window.
+ * \param from The earlier event.
+ * \param into The later event, which grows to cover both areas.
+ */
+static void
+event_fold_expose(const xcb_expose_event_t *from, xcb_expose_event_t *into)
+{
+    int x1 = MIN(from->x, into->x);
+    int y1 = MIN(from->y, into->y);
+    int x2 = MAX(from->x + from->width, into->x + into->width);
+    int y2 = MAX(from->y + from->height, into->y + into->height);
+
+    into->x = x1;
+    into->y = y1;
+    into->width = x2 - x1;
+    into->height = y2 - y1;
+}
+
+/** Read all queued events, dropping the ones a later event makes redundant.
+ * \param events The array to fill with the events to handle.
+ */
+static void
+a_xcb_read_events(xcb_generic_event_array_t *events)
+{
+    static GHashTable *latest = NULL;
+    xcb_generic_event_t *event;
+    int mouse = -1;
+
+    if(!latest)
+        latest = g_hash_table_new(event_fold_hash, event_fold_equal);
+
+    while((event = poll_for_event()))
+    {
+        uint8_t type = XCB_EVENT_RESPONSE_TYPE(event);
+        int idx = events->len;
+        gpointer key, value;
+
+        switch(type)
+        {
+          case XCB_MOTION_NOTIFY:
+            /* We cannot afford to treat all mouse motion events,
+             * because that would be too much CPU intensive, so we just
+             * take the last we get until something else happens with the
+             * pointer. */
+            if(mouse >= 0)
             {
-                /* Make sure enter/motion/leave/press/release events are handled
-                 * in the correct order */
-                event_handle(mouse);
-                p_delete(&mouse);
+                p_delete(&events->tab[mouse]);
+                globalconf.folded_events++;
             }
-            event_handle(event);
-            p_delete(&event);
+            mouse = idx;
+            break;
+          case XCB_ENTER_NOTIFY:
+          case XCB_LEAVE_NOTIFY:
+          case XCB_BUTTON_PRESS:
+          case XCB_BUTTON_RELEASE:
+            /* Make sure enter/motion/leave/press/release events are handled
+             * in the correct order */
+            mouse = -1;
+            break;
+          case XCB_PROPERTY_NOTIFY:
+          case XCB_EXPOSE:
+          case XCB_CONFIGURE_NOTIFY:
+            if(g_hash_table_lookup_extended(latest, event, &key, &value))
+            {
+                int old = GPOINTER_TO_INT(value);
+                if(type == XCB_EXPOSE)
+                    event_fold_expose((void *) events->tab[old], (void *) event);
+                /* The key is the old event, replace it before freeing that */
+                g_hash_table_replace(latest, event, GINT_TO_POINTER(idx));
+                p_delete(&events->tab[old]);
+                globalconf.folded_events++;
+            }
+            else
+                g_hash_table_insert(latest, event, GINT_TO_POINTER(idx));
+            break;
+          case XCB_MAP_REQUEST:
+          case XCB_UNMAP_NOTIFY:
+          case XCB_DESTROY_NOTIFY:
+          case XCB_REPARENT_NOTIFY:
+            /* Windows are (un)managed here, so earlier events must still be
+             * seen with the state they were sent in. This also protects
+             * against window ids being reused. */
+            g_hash_table_remove_all(latest);
+            break;
         }
+
+        xcb_generic_event_array_append(events, event);
     }
 
-    if(mouse)
+    g_hash_table_remove_all(latest);
+}
+
+static void
+a_xcb_check(void)
+{
+    static xcb_generic_event_array_t events;
+    int count;
+
+    /* Handling events may cause new ones, so go on until the queue is empty */
+    do
     {
-        event_handle(mouse);
-        p_delete(&mouse);
-    }
+        a_xcb_read_events(&events);
+        count = events.len;
+
+        foreach(event, events)
+            if(*event)
+            {
+                /* Property updates are batched so that their replies only
+                 * cost one round-trip, but they must be done before anything
+                 * else happens */
+                if(XCB_EVENT_RESPONSE_TYPE(*event) != XCB_PROPERTY_NOTIFY)
+                    property_handle_pending();
+                event_handle(*event);
+                p_delete(event);
+            }
+        property_handle_pending();
+
+        events.len = 0;
+    } while(count > 0);
 }
 
 static gboolean
@@ -364,6 +517,10 @@ a_glib_poll(GPollFD *ufds, guint nfsd, gint timeout)
     float length;
     lua_State *L = globalconf_get_lua_State();
 
+    /* GLib dispatched its sources (e.g. timers) since we last returned */
+    if (profile_dispatch_start)
+        profile_phase_done(PROFILE_GLIB_DISPATCH, profile_dispatch_start);
+
     /* Do all deferred work now */
     awesome_refresh();
 
@@ -390,10 +547,15 @@ a_glib_poll(GPollFD *ufds, guint nfsd, gint timeout)
         main_loop_iteration_limit = length;
     }
 
+    if (profile_wakeup)
+        profile_phase_done(PROFILE_ITERATION, profile_wakeup);
+
     /* Actually do the polling, record time of wakeup and check for new xcb events */
     res = g_poll(ufds, nfsd, timeout);
     gettimeofday(&last_wakeup, NULL);
+    profile_wakeup = profile_now();
     a_xcb_check();
+    profile_dispatch_start = profile_phase_done(PROFILE_X_EVENTS, profile_wakeup);
 
     return res;
 }
@@ -498,6 +660,7 @@ main(int argc, char **argv)
     globalconf.exit_code = EXIT_SUCCESS;
     buffer_init(&globalconf.startup_errors);
     string_array_init(&searchpath);
+    window_index_init();
 
     /* save argv */
     for(i = 0; i < argc; i++)
@@ -38,6 +38,13 @@ DO_ARRAY(lua_class_t *, lua_class, DO_NOTHING)
 
 static lua_class_array_t luaA_classes;
 
+/** Bumped each time a property is added to any class */
+static unsigned int lua_class_property_generation = 1;
+
+/** Placeholders for the properties every object has */
+static lua_class_property_t lua_class_property_valid = { .name = "valid" };
+static lua_class_property_t lua_class_property_data = { .name = "data" };
+
 /** Convert a object to a udata if possible.
  * \param L The Lua VM state.
  * \param ud The index.
@@ -161,6 +168,7 @@ luaA_class_add_property(lua_class_t *lua_class,
                                         .index = cb_index,
                                         .newindex = cb_newindex
                                     });
+    lua_class_property_generation++;
 }
 
 /** Newindex meta function for objects after they were GC'd.
@@ -284,6 +292,8 @@ luaA_class_setup(lua_State *L, lua_class_t *class,
     class->instances = 0;
     class->index_miss_handler = LUA_REFNIL;
     class->newindex_miss_handler = LUA_REFNIL;
+    class->properties_flat = LUA_REFNIL;
+    class->properties_flat_generation = 0;
 
     lua_class_array_append(&luaA_classes, class);
 }
@@ -321,6 +331,13 @@ luaA_class_emit_signal(lua_State *L, lua_class_t *lua_class,
     signal_object_emit(L, &lua_class->signals, name, nargs);
 }
 
+void
+luaA_class_emit_signal_id(lua_State *L, lua_class_t *lua_class,
+                          unsigned long id, int nargs)
+{
+    signal_object_emit_id(L, &lua_class->signals, id, nargs);
+}
+
 /** Try to use the metatable of an object.
  * \param L The Lua VM state.
  * \param idxobj The index of the object.
@@ -356,12 +373,72 @@ luaA_usemetatable(lua_State *L, int idxobj, int idxfield)
     return 0;
 }
 
+/** Push the table mapping property names of a class to their
+ * lua_class_property_t, including the properties of all parent classes.
+ * The table is rebuilt when properties were added since it was last built.
+ * \param L The Lua VM state.
+ * \param lua_class The Lua class.
+ */
+static void
+luaA_class_properties_flat_push(lua_State *L, lua_class_t *lua_class)
+{
+    if(lua_class->properties_flat_generation == lua_class_property_generation)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, lua_class->properties_flat);
+        return;
+    }
+
+    luaL_unref(L, LUA_REGISTRYINDEX, lua_class->properties_flat);
+
+    lua_newtable(L);
+    lua_pushlightuserdata(L, &lua_class_property_valid);
+    lua_setfield(L, -2, lua_class_property_valid.name);
+    lua_pushlightuserdata(L, &lua_class_property_data);
+    lua_setfield(L, -2, lua_class_property_data.name);
+
+    /* Go from the top-most parent down, so that child classes override the
+     * properties of their parents */
+    int depth = 0;
+    for(lua_class_t *class = lua_class; class; class = class->parent)
+        depth++;
+    lua_class_t **chain = p_alloca(lua_class_t *, depth);
+    int i = depth;
+    for(lua_class_t *class = lua_class; class; class = class->parent)
+        chain[--i] = class;
+
+    for(i = 0; i < depth; i++)
+        foreach(prop, chain[i]->properties)
+        {
+            lua_pushlightuserdata(L, prop);
+            lua_setfield(L, -2, prop->name);
+        }
+
+    lua_pushvalue(L, -1);
+    lua_class->properties_flat = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_class->properties_flat_generation = lua_class_property_generation;
+}
+
+/** Look up a property of an object, including the 'valid' and 'data'
+ * placeholders.
+ * \param L The Lua VM state.
+ * \param lua_class The Lua class.
+ * \param fieldidx The index of the field name.
+ * \return The object property if found, NULL otherwise.
+ */
 static lua_class_property_t *
-lua_class_property_array_getbyname(lua_class_property_array_t *arr,
-                                   const char *name)
+luaA_class_property_lookup(lua_State *L, lua_class_t *lua_class, int fieldidx)
 {
-    lua_class_property_t lookup_prop = { .name = name };
-    return lua_class_property_array_lookup(arr, &lookup_prop);
+    /* This converts numbers to strings, so that the raw lookup finds them */
+    luaL_checkstring(L, fieldidx);
+    fieldidx = luaA_absindex(L, fieldidx);
+
+    luaA_class_properties_flat_push(L, lua_class);
+    lua_pushvalue(L, fieldidx);
+    lua_rawget(L, -2);
+    lua_class_property_t *prop = lua_touserdata(L, -1);
+    lua_pop(L, 2);
+
+    return prop;
 }
 
 /** Get a property of a object.
@@ -373,20 +450,12 @@ lua_class_property_array_getbyname(lua_class_property_array_t *arr,
 static lua_class_property_t *
 luaA_class_property_get(lua_State *L, lua_class_t *lua_class, int fieldidx)
 {
-    /* Lookup the property using token */
-    const char *attr = luaL_checkstring(L, fieldidx);
+    lua_class_property_t *prop = luaA_class_property_lookup(L, lua_class, fieldidx);
 
-    /* Look for the property in the class; if not found, go in the parent class. */
-    for(; lua_class; lua_class = lua_class->parent)
-    {
-        lua_class_property_t *prop =
-            lua_class_property_array_getbyname(&lua_class->properties, attr);
-
-        if(prop)
-            return prop;
-    }
+    if(prop == &lua_class_property_valid || prop == &lua_class_property_data)
+        return NULL;
 
-    return NULL;
+    return prop;
 }
 
 /** Call a registered function.
@@ -436,10 +505,11 @@ luaA_class_index(lua_State *L)
 
     lua_class_t *class = luaA_class_get(L, 1);
 
+    lua_class_property_t *prop = luaA_class_property_lookup(L, class, 2);
+
     /* Is this the special 'valid' property? This is the only property
      * accessible for invalid objects and thus needs special handling. */
-    const char *attr = luaL_checkstring(L, 2);
-    if (A_STREQ(attr, "valid"))
+    if (prop == &lua_class_property_valid)
     {
         void *p = luaA_toudata(L, 1, class);
         if (class->checker)
@@ -449,12 +519,10 @@ luaA_class_index(lua_State *L)
         return 1;
     }
 
-    lua_class_property_t *prop = luaA_class_property_get(L, class, 2);
-
     /* Is this the special 'data' property? This is available on all objects and
      * thus not implemented as a lua_class_property_t.
      */
-    if (A_STREQ(attr, "data"))
+    if (prop == &lua_class_property_data)
     {
         luaA_checkudata(L, 1, class);
         luaA_getuservalue(L, 1);
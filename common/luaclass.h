@@ -78,6 +78,10 @@ struct lua_class_t
     int index_miss_handler;
     /** Function to call on newindex misses */
     int newindex_miss_handler;
+    /** Reference to the table of all properties of this class and its parents */
+    int properties_flat;
+    /** Property generation properties_flat was built for */
+    unsigned int properties_flat_generation;
 };
 
 const char * luaA_typename(lua_State *, int);
@@ -87,6 +91,8 @@ void luaA_class_connect_signal(lua_State *, lua_class_t *, const char *, lua_CFu
 void luaA_class_connect_signal_from_stack(lua_State *, lua_class_t *, const char *, int);
 void luaA_class_disconnect_signal_from_stack(lua_State *, lua_class_t *, const char *, int);
 void luaA_class_emit_signal(lua_State *, lua_class_t *, const char *, int);
+void luaA_class_emit_signal_id(lua_State *, lua_class_t *, unsigned long, int);
+unsigned long luaA_checksignal(lua_State *, int);
 
 void luaA_openlib(lua_State *, const char *, const struct luaL_Reg[], const struct luaL_Reg[]);
 void luaA_class_setup(lua_State *, lua_class_t *, const char *, lua_class_t *,
@@ -146,8 +152,8 @@ luaA_checkudataornil(lua_State *L, int udx, lua_class_t *class)
     static inline int                                                          \
     luaA_##prefix##_class_emit_signal(lua_State *L)                            \
     {                                                                          \
-        luaA_class_emit_signal(L, &(lua_class), luaL_checkstring(L, 1),        \
-                               lua_gettop(L) - 1);                             \
+        luaA_class_emit_signal_id(L, &(lua_class), luaA_checksignal(L, 1),     \
+                                  lua_gettop(L) - 1);                          \
         return 0;                                                              \
     }                                                                          \
                                                                                \
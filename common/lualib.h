@@ -25,6 +25,7 @@
 #include <lua.h>
 
 #include "common/util.h"
+#include "profile.h"
 
 /** Lua function to call on dofunction() error */
 lua_CFunction lualib_dofunction_on_error;
@@ -72,7 +73,10 @@ luaA_dofunction(lua_State *L, int nargs, int nret)
     /* Move error handling function before args and function */
     lua_insert(L, - nargs - 2);
     int error_func_pos = lua_gettop(L) - nargs - 1;
-    if(lua_pcall(L, nargs, nret, - nargs - 2))
+    int64_t start = profile_callback_start();
+    bool failed = lua_pcall(L, nargs, nret, - nargs - 2);
+    profile_callback_done(start);
+    if(failed)
     {
         warn("%s", lua_tostring(L, -1));
         /* Remove error function and error string */
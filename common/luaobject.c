@@ -28,14 +28,36 @@
  */
 
 #include "common/luaobject.h"
+#include "profile.h"
 #include "common/backtrace.h"
 
+/** Registry key of the table caching the ids of signal names used from Lua */
+static char signal_ids_key;
+
+/** Number of emits which were skipped because nothing was connected */
+static unsigned long signal_skipped_emits;
+
+/** Get the number of signal emits which did not have to do anything because
+ * no handler was connected to the signal.
+ * \return The number of skipped emits.
+ */
+unsigned long
+signal_get_skipped_emits(void)
+{
+    return signal_skipped_emits;
+}
+
 /** Setup the object system at startup.
  * \param L The Lua VM state.
  */
 void
 luaA_object_setup(lua_State *L)
 {
+    /* Create the signal id cache */
+    lua_pushlightuserdata(L, &signal_ids_key);
+    lua_newtable(L);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+
     /* Push identification string */
     lua_pushliteral(L, LUAA_OBJECT_REGISTRY_KEY);
     /* Create an empty table */
@@ -227,88 +249,188 @@ luaA_object_disconnect_signal_from_stack(lua_State *L, int oud,
     lua_remove(L, ud);
 }
 
+/** Get the id of a signal name given from Lua.
+ * The ids are cached, so that the name does not have to be hashed each time.
+ * \param L The Lua VM state.
+ * \param idx The index of the signal name on the stack.
+ * \return The signal id.
+ */
+unsigned long
+luaA_checksignal(lua_State *L, int idx)
+{
+    const char *name = luaL_checkstring(L, idx);
+    unsigned long id;
+
+    idx = luaA_absindex(L, idx);
+    lua_pushlightuserdata(L, &signal_ids_key);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    lua_pushvalue(L, idx);
+    lua_rawget(L, -2);
+    if(lua_islightuserdata(L, -1))
+        id = (unsigned long) lua_touserdata(L, -1);
+    else
+    {
+        id = signal_intern(name);
+        lua_pushvalue(L, idx);
+        lua_pushlightuserdata(L, (void *) id);
+        lua_rawset(L, -4);
+    }
+    lua_pop(L, 2);
+
+    return id;
+}
+
 void
 signal_object_emit(lua_State *L, signal_array_t *arr, const char *name, int nargs)
 {
-    signal_t *sigfound = signal_array_getbyid(arr,
-                                              a_strhash((const unsigned char *) name));
+    signal_object_emit_id(L, arr, signal_intern(name), nargs);
+}
 
-    if(sigfound)
+/** Call signal handlers which were pushed on the stack.
+ * Every handler gets the arguments pushed from their fixed stack slots, so
+ * the stack is never reordered while the handlers run.
+ * \param L The Lua VM state.
+ * \param first_func The absolute index of the first handler.
+ * \param nbfunc The number of handlers.
+ * \param self The absolute index of the object to pass first, or 0.
+ * \param first_arg The absolute index of the first argument.
+ * \param nargs The number of arguments.
+ */
+static void
+signal_call_handlers(lua_State *L, int first_func, int nbfunc,
+                     int self, int first_arg, int nargs)
+{
+    int nparams = nargs + (self ? 1 : 0);
+
+    lua_pushcfunction(L, luaA_dofunction_error);
+    int error_func_pos = lua_gettop(L);
+
+    for(int i = 0; i < nbfunc; i++)
+    {
+        lua_pushvalue(L, first_func + i);
+        if(self)
+            lua_pushvalue(L, self);
+        for(int j = 0; j < nargs; j++)
+            lua_pushvalue(L, first_arg + j);
+        int64_t start = profile_callback_start();
+        bool failed = lua_pcall(L, nparams, 0, error_func_pos);
+        profile_callback_done(start);
+        if(failed)
+        {
+            warn("%s", lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+
+    /* Remove error function */
+    lua_pop(L, 1);
+}
+
+void
+signal_object_emit_id(lua_State *L, signal_array_t *arr, unsigned long id, int nargs)
+{
+    signal_t *sigfound = arr->len > 0 ? signal_array_getbyid(arr, id) : NULL;
+
+    if(!sigfound)
+        signal_skipped_emits++;
+    else
     {
         int nbfunc = sigfound->sigfuncs.len;
-        luaL_checkstack(L, nbfunc + nargs + 1, "too much signal");
+        int first_arg = lua_gettop(L) - nargs + 1;
+        luaL_checkstack(L, nbfunc + nargs + 2, "too much signal");
         /* Push all functions and then execute, because this list can change
          * while executing funcs. */
         foreach(func, sigfound->sigfuncs)
             luaA_object_push(L, *func);
 
-        for(int i = 0; i < nbfunc; i++)
-        {
-            /* push all args */
-            for(int j = 0; j < nargs; j++)
-                lua_pushvalue(L, - nargs - nbfunc + i);
-            /* push first function */
-            lua_pushvalue(L, - nargs - nbfunc + i);
-            /* remove this first function */
-            lua_remove(L, - nargs - nbfunc - 1 + i);
-            luaA_dofunction(L, nargs, 0);
-        }
+        signal_call_handlers(L, first_arg + nargs, nbfunc, 0, first_arg, nargs);
+        lua_pop(L, nbfunc);
     }
 
     /* remove args */
     lua_pop(L, nargs);
 }
 
-/** Emit a signal.
- * @tparam string name A signal name.
- * @param[opt] ... Various arguments.
- * @function emit_signal
+/** Emit a signal on an object and its class.
+ * \param L The Lua VM state.
+ * \param oud The object index on the stack.
+ * \param name The signal name for error messages, can be NULL.
+ * \param id The signal id.
+ * \param nargs The number of arguments to the signal.
  */
-void
-luaA_object_emit_signal(lua_State *L, int oud,
-                        const char *name, int nargs)
+static void
+object_emit_signal(lua_State *L, int oud,
+                   const char *name, unsigned long id, int nargs)
 {
     int oud_abs = luaA_absindex(L, oud);
     lua_class_t *lua_class = luaA_class_get(L, oud);
     lua_object_t *obj = luaA_toudata(L, oud, lua_class);
     if(!obj) {
-        luaA_warn(L, "Trying to emit signal '%s' on non-object", name);
+        luaA_warn(L, "Trying to emit signal '%s' on non-object", NONULL(name));
         return;
     }
     else if(lua_class->checker && !lua_class->checker(obj)) {
-        luaA_warn(L, "Trying to emit signal '%s' on invalid object", name);
+        luaA_warn(L, "Trying to emit signal '%s' on invalid object", NONULL(name));
+        return;
+    }
+    signal_t *sigfound = obj->signals.len > 0 ? signal_array_getbyid(&obj->signals, id) : NULL;
+
+    /* Nothing connected on the object or its class, just drop the args */
+    if(!sigfound && !signal_array_has_handlers(&lua_class->signals, id))
+    {
+        signal_skipped_emits++;
+        lua_pop(L, nargs);
         return;
     }
-    signal_t *sigfound = signal_array_getbyid(&obj->signals,
-                                              a_strhash((const unsigned char *) name));
+
     if(sigfound)
     {
         int nbfunc = sigfound->sigfuncs.len;
-        luaL_checkstack(L, nbfunc + nargs + 2, "too much signal");
+        int first_arg = lua_gettop(L) - nargs + 1;
+        luaL_checkstack(L, nbfunc + nargs + 3, "too much signal");
         /* Push all functions and then execute, because this list can change
          * while executing funcs. */
         foreach(func, sigfound->sigfuncs)
             luaA_object_push_item(L, oud_abs, *func);
 
-        for(int i = 0; i < nbfunc; i++)
-        {
-            /* push object */
-            lua_pushvalue(L, oud_abs);
-            /* push all args */
-            for(int j = 0; j < nargs; j++)
-                lua_pushvalue(L, - nargs - nbfunc - 1 + i);
-            /* push first function */
-            lua_pushvalue(L, - nargs - nbfunc - 1 + i);
-            /* remove this first function */
-            lua_remove(L, - nargs - nbfunc - 2 + i);
-            luaA_dofunction(L, nargs + 1, 0);
-        }
+        signal_call_handlers(L, first_arg + nargs, nbfunc, oud_abs, first_arg, nargs);
+        lua_pop(L, nbfunc);
     }
 
     /* Then emit signal on the class */
+    if(!signal_array_has_handlers(&lua_class->signals, id))
+    {
+        lua_pop(L, nargs);
+        return;
+    }
     lua_pushvalue(L, oud);
     lua_insert(L, - nargs - 1);
-    luaA_class_emit_signal(L, luaA_class_get(L, - nargs - 1), name, nargs + 1);
+    luaA_class_emit_signal_id(L, lua_class, id, nargs + 1);
+}
+
+/** Emit a signal.
+ * @tparam string name A signal name.
+ * @param[opt] ... Various arguments.
+ * @function emit_signal
+ */
+void
+luaA_object_emit_signal(lua_State *L, int oud,
+                        const char *name, int nargs)
+{
+    object_emit_signal(L, oud, name, signal_intern(name), nargs);
+}
+
+/** Emit a signal given by its id, see SIGNAL_ID().
+ * \param L The Lua VM state.
+ * \param oud The object index on the stack.
+ * \param id The signal id.
+ * \param nargs The number of arguments to the signal.
+ */
+void
+luaA_object_emit_signal_id(lua_State *L, int oud,
+                           unsigned long id, int nargs)
+{
+    object_emit_signal(L, oud, NULL, id, nargs);
 }
 
 int
@@ -328,7 +450,8 @@ luaA_object_disconnect_signal_simple(lua_State *L)
 int
 luaA_object_emit_signal_simple(lua_State *L)
 {
-    luaA_object_emit_signal(L, 1, luaL_checkstring(L, 2), lua_gettop(L) - 2);
+    unsigned long id = luaA_checksignal(L, 2);
+    object_emit_signal(L, 1, lua_tostring(L, 2), id, lua_gettop(L) - 2);
     return 0;
 }
 
@@ -149,13 +149,16 @@ luaA_object_push(lua_State *L, const void *pointer)
     return 1;
 }
 
+unsigned long signal_get_skipped_emits(void);
 void signal_object_emit(lua_State *, signal_array_t *, const char *, int);
+void signal_object_emit_id(lua_State *, signal_array_t *, unsigned long, int);
 
 void luaA_object_connect_signal(lua_State *, int, const char *, lua_CFunction);
 void luaA_object_disconnect_signal(lua_State *, int, const char *, lua_CFunction);
 void luaA_object_connect_signal_from_stack(lua_State *, int, const char *, int);
 void luaA_object_disconnect_signal_from_stack(lua_State *, int, const char *, int);
 void luaA_object_emit_signal(lua_State *, int, const char *, int);
+void luaA_object_emit_signal_id(lua_State *, int, unsigned long, int);
 
 int luaA_object_connect_signal_simple(lua_State *);
 int luaA_object_disconnect_signal_simple(lua_State *);
@@ -0,0 +1,94 @@
+/*
+ * premultiply.c - premultiplied alpha conversion
+ *
+ * Copyright © 2017 The awesome developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "common/premultiply.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/** Multiply a color channel with an alpha value, rounding correctly.
+ * \param c The color channel.
+ * \param a The alpha value.
+ * \return c * a / 255, rounded to the nearest integer.
+ */
+static inline uint32_t
+premultiply_mul_un8(uint32_t c, uint32_t a)
+{
+    uint32_t t = c * a + 0x80;
+    return (t + (t >> 8)) >> 8;
+}
+
+/** Convert pixels from ARGB to premultiplied ARGB, as cairo wants it.
+ * \param dst Where to store the converted pixels. May be the same as src.
+ * \param src The pixels to convert.
+ * \param len The number of pixels.
+ */
+void
+premultiply_argb(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    /* Four pixels at a time, with each channel in a 16 bit lane. The alpha
+     * channel is multiplied with 255 so that it stays unchanged. */
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgb_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alpha_factor = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i round = _mm_set1_epi16(0x80);
+
+    for(; i + 4 <= len; i += 4)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+
+        alo = _mm_or_si128(_mm_and_si128(alo, rgb_mask), alpha_factor);
+        ahi = _mm_or_si128(_mm_and_si128(ahi, rgb_mask), alpha_factor);
+        lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), round);
+        hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), round);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for(; i < len; i++)
+    {
+        uint32_t px = src[i];
+        uint32_t a = px >> 24;
+
+        if(a == 0xff)
+            dst[i] = px;
+        else if(a == 0)
+            dst[i] = 0;
+        else
+            dst[i] = (a << 24)
+                | (premultiply_mul_un8((px >> 16) & 0xff, a) << 16)
+                | (premultiply_mul_un8((px >>  8) & 0xff, a) << 8)
+                | premultiply_mul_un8(px & 0xff, a);
+    }
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -54,6 +54,40 @@ signal_array_getbyid(signal_array_t *arr, unsigned long id)
     return signal_array_lookup(arr, &sig);
 }
 
+/** Check if anything is connected to a signal.
+ * \param arr The signal array.
+ * \param id The signal id.
+ * \return True if the signal has handlers.
+ */
+static inline bool
+signal_array_has_handlers(signal_array_t *arr, unsigned long id)
+{
+    return arr->len > 0 && signal_array_getbyid(arr, id) != NULL;
+}
+
+/** Get the id of a signal name.
+ * \param name The signal name.
+ * \return The signal id.
+ */
+static inline unsigned long
+signal_intern(const char *name)
+{
+    return a_strhash((const unsigned char *) name);
+}
+
+/** Get the id of a constant signal name. The name is only hashed the first
+ * time a call site is reached.
+ * \param name The signal name, which must always be the same for a call site.
+ * \return The signal id.
+ */
+#define SIGNAL_ID(name)                                 \
+    ({                                                  \
+        static unsigned long __signal_id;               \
+        if(!__signal_id)                                \
+            __signal_id = signal_intern(name);          \
+        __signal_id;                                    \
+    })
+
 /** Connect a signal inside a signal array.
  * You are in charge of reference counting.
  * \param arr The signal array.
@@ -63,7 +97,7 @@ signal_array_getbyid(signal_array_t *arr, unsigned long id)
 static inline void
 signal_connect(signal_array_t *arr, const char *name, const void *ref)
 {
-    unsigned long tok = a_strhash((const unsigned char *) name);
+    unsigned long tok = signal_intern(name);
     signal_t *sigfound = signal_array_getbyid(arr, tok);
     if(sigfound)
         cptr_array_append(&sigfound->sigfuncs, ref);
@@ -84,8 +118,7 @@ signal_connect(signal_array_t *arr, const char *name, const void *ref)
 static inline bool
 signal_disconnect(signal_array_t *arr, const char *name, const void *ref)
 {
-    signal_t *sigfound = signal_array_getbyid(arr,
-                                              a_strhash((const unsigned char *) name));
+    signal_t *sigfound = signal_array_getbyid(arr, signal_intern(name));
     if(sigfound)
     {
         foreach(func, sigfound->sigfuncs)
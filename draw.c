@@ -22,6 +22,8 @@
 #include "config.h"
 #include "draw.h"
 #include "globalconf.h"
+#include "luaa.h"
+#include "common/premultiply.h"
 
 #include <langinfo.h>
 #include <iconv.h>
@@ -105,20 +107,11 @@ cairo_surface_t *
 draw_surface_from_data(int width, int height, uint32_t *data)
 {
     unsigned long int len = width * height;
-    unsigned long int i;
     uint32_t *buffer = p_new(uint32_t, len);
     cairo_surface_t *surface;
 
     /* Cairo wants premultiplied alpha, meh :( */
-    for(i = 0; i < len; i++)
-    {
-        uint8_t a = (data[i] >> 24) & 0xff;
-        double alpha = a / 255.0;
-        uint8_t r = ((data[i] >> 16) & 0xff) * alpha;
-        uint8_t g = ((data[i] >>  8) & 0xff) * alpha;
-        uint8_t b = ((data[i] >>  0) & 0xff) * alpha;
-        buffer[i] = (a << 24) | (r << 16) | (g << 8) | b;
-    }
+    premultiply_argb(buffer, data, len);
 
     surface =
         cairo_image_surface_create_for_data((unsigned char *) buffer,
@@ -173,13 +166,11 @@ draw_surface_from_pixbuf(GdkPixbuf *buf)
                 uint8_t g = *row++;
                 uint8_t b = *row++;
                 uint8_t a = *row++;
-                double alpha = a / 255.0;
-                r = r * alpha;
-                g = g * alpha;
-                b = b * alpha;
                 *cairo++ = (a << 24) | (r << 16) | (g << 8) | b;
             }
         }
+        if (channels == 4)
+            premultiply_argb((uint32_t *) cairo_pixels, (uint32_t *) cairo_pixels, width);
         pixels += pix_stride;
         cairo_pixels += cairo_stride;
     }
@@ -247,6 +238,152 @@ draw_load_image(lua_State *L, const char *path, GError **error)
     return ret;
 }
 
+/** Number of threads that decode images for draw_load_image_async() */
+#define DRAW_IMAGE_THREADS 4
+
+DO_ARRAY(int, int, DO_NOTHING)
+
+/** An image which is being loaded by draw_load_image_async() */
+typedef struct
+{
+    /** Key in draw_image_requests */
+    char *key;
+    char *path;
+    /** Maximum width and height, or 0 for the image's own size */
+    int size;
+    /** References to the Lua functions waiting for this image */
+    int_array_t callbacks;
+    /** The result, set by the worker thread */
+    cairo_surface_t *surface;
+    GError *error;
+} draw_image_request_t;
+
+/** The images which are being loaded, by path and size */
+static GHashTable *draw_image_requests;
+static GThreadPool *draw_image_pool;
+/** Number of images that were given to draw_image_pool for decoding */
+static unsigned long draw_image_decodes;
+
+/** Give the result of an image load to the Lua callbacks. This runs in the
+ * main loop.
+ * \param data The request.
+ * \return FALSE, to remove the idle source.
+ */
+static gboolean
+draw_image_loaded(gpointer data)
+{
+    draw_image_request_t *request = data;
+    lua_State *L = globalconf_get_lua_State();
+
+    g_hash_table_remove(draw_image_requests, request->key);
+
+    foreach(callback, request->callbacks)
+    {
+        if (request->surface)
+        {
+            /* lua has to make sure to free the ref or we have a leak */
+            lua_pushlightuserdata(L, cairo_surface_reference(request->surface));
+            lua_pushnil(L);
+        } else {
+            lua_pushnil(L);
+            lua_pushstring(L, request->error ? request->error->message : "Unknown error");
+        }
+        lua_rawgeti(L, LUA_REGISTRYINDEX, *callback);
+        luaA_unregister(L, callback);
+        luaA_dofunction(L, 2, 0);
+    }
+
+    if (request->surface)
+        cairo_surface_destroy(request->surface);
+    if (request->error)
+        g_error_free(request->error);
+    int_array_wipe(&request->callbacks);
+    p_delete(&request->path);
+    g_free(request->key);
+    p_delete(&request);
+
+    return FALSE;
+}
+
+/** Decode an image. This runs in a thread of draw_image_pool.
+ * \param data The request.
+ * \param user_data Unused.
+ */
+static void
+draw_image_load_worker(gpointer data, gpointer user_data)
+{
+    draw_image_request_t *request = data;
+    GdkPixbuf *buf;
+
+    if (request->size > 0)
+        buf = gdk_pixbuf_new_from_file_at_size(request->path, request->size,
+                                               request->size, &request->error);
+    else
+        buf = gdk_pixbuf_new_from_file(request->path, &request->error);
+
+    if (buf)
+    {
+        request->surface = draw_surface_from_pixbuf(buf);
+        g_object_unref(buf);
+    }
+
+    g_idle_add(draw_image_loaded, request);
+}
+
+/** Load an image in a separate thread.
+ * Loads of the same image that are started before the first one finished
+ * share its result.
+ * \param L The Lua VM state.
+ * \param path The file to load.
+ * \param size The maximum width and height, or 0 for the image's own size.
+ * \param fidx The index of the Lua function to call with the result.
+ */
+void
+draw_load_image_async(lua_State *L, const char *path, int size, int fidx)
+{
+    draw_image_request_t *request;
+    int callback = LUA_REFNIL;
+    char *key;
+
+    luaA_registerfct(L, fidx, &callback);
+    key = g_strdup_printf("%d:%s", size, path);
+
+    if (!draw_image_requests)
+        draw_image_requests = g_hash_table_new(g_str_hash, g_str_equal);
+
+    request = g_hash_table_lookup(draw_image_requests, key);
+    if (request)
+    {
+        int_array_append(&request->callbacks, callback);
+        g_free(key);
+        return;
+    }
+
+    request = p_new(draw_image_request_t, 1);
+    request->key = key;
+    request->path = a_strdup(path);
+    request->size = size;
+    int_array_append(&request->callbacks, callback);
+    g_hash_table_insert(draw_image_requests, key, request);
+
+    if (!draw_image_pool)
+        draw_image_pool = g_thread_pool_new(draw_image_load_worker, NULL,
+                                            DRAW_IMAGE_THREADS, FALSE, NULL);
+    draw_image_decodes++;
+    g_thread_pool_push(draw_image_pool, request, NULL);
+}
+
+/** Get the number of images that draw_load_image_async() decoded, including
+ * those that failed to load. Loads that shared the result of another one are
+ * not counted.
+ * \return The number of decodes.
+ */
+unsigned long
+draw_get_image_decodes(void)
+{
+    return draw_image_decodes;
+}
+
 xcb_visualtype_t *draw_find_visual(const xcb_screen_t *s, xcb_visualid_t visual)
 {
     xcb_depth_iterator_t depth_iter = xcb_screen_allowed_depths_iterator(s);
@@ -24,6 +24,7 @@
 
 #include "banning.h"
 #include "globalconf.h"
+#include "profile.h"
 #include "stack.h"
 
 #include <xcb/xcb.h>
@@ -45,13 +46,21 @@ void screen_refresh(void);
 static inline int
 awesome_refresh(void)
 {
+    int64_t t = profile_now();
     screen_refresh();
+    t = profile_phase_done(PROFILE_SCREEN_REFRESH, t);
     luaA_emit_refresh();
+    t = profile_phase_done(PROFILE_LUA_REFRESH, t);
     drawin_refresh();
+    t = profile_phase_done(PROFILE_DRAWIN_REFRESH, t);
     client_refresh();
+    t = profile_phase_done(PROFILE_CLIENT_REFRESH, t);
     banning_refresh();
+    t = profile_phase_done(PROFILE_BANNING_REFRESH, t);
     stack_refresh();
+    t = profile_phase_done(PROFILE_STACK_REFRESH, t);
     client_destroy_later();
+    profile_phase_done(PROFILE_DESTROY_LATER, t);
     return xcb_flush(globalconf.connection);
 }
 
@@ -663,7 +663,131 @@ ewmh_process_client_strut(client_t *c)
     p_delete(&strut_r);
 }
 
+/** Number of 32 bit units of NET_WM_ICON that are requested at first. Icons
+ * which fit into this need no further requests. */
+#define EWMH_ICON_FIRST_CHUNK 4096
+
+/** Maximum number of unused icons which are kept in the cache */
+#define EWMH_ICON_CACHE_UNUSED 16
+
+/** A decoded _NET_WM_ICON, shared by all clients with the same icon */
+typedef struct
+{
+    /** Hash of the size and the pixels */
+    guint hash;
+    uint32_t width, height;
+    /** The pixels as found in the property, to tell apart icons with the
+     * same hash */
+    uint32_t *data;
+    /** The premultiplied icon, the cache owns one reference */
+    cairo_surface_t *surface;
+} ewmh_icon_t;
+
+static GHashTable *ewmh_icon_cache;
+static unsigned long ewmh_icon_cache_hits, ewmh_icon_cache_misses;
+
+static guint
+ewmh_icon_hash(gconstpointer key)
+{
+    return ((const ewmh_icon_t *) key)->hash;
+}
+
+static gboolean
+ewmh_icon_equal(gconstpointer a, gconstpointer b)
+{
+    const ewmh_icon_t *x = a, *y = b;
+    return x->hash == y->hash && x->width == y->width && x->height == y->height
+        && memcmp(x->data, y->data, sizeof(uint32_t) * x->width * x->height) == 0;
+}
+
+static void
+ewmh_icon_free(gpointer data)
+{
+    ewmh_icon_t *icon = data;
+    cairo_surface_destroy(icon->surface);
+    p_delete(&icon->data);
+    p_delete(&icon);
+}
+
+/** Remove icons which are no longer used by any client from the cache, if
+ * there are too many of them.
+ */
+static void
+ewmh_icon_cache_trim(void)
+{
+    GHashTableIter iter;
+    gpointer key;
+    unsigned int unused = 0;
+
+    g_hash_table_iter_init(&iter, ewmh_icon_cache);
+    while(g_hash_table_iter_next(&iter, &key, NULL))
+        if(cairo_surface_get_reference_count(((ewmh_icon_t *) key)->surface) == 1)
+            unused++;
+
+    if(unused <= EWMH_ICON_CACHE_UNUSED)
+        return;
+
+    g_hash_table_iter_init(&iter, ewmh_icon_cache);
+    while(g_hash_table_iter_next(&iter, &key, NULL))
+        if(cairo_surface_get_reference_count(((ewmh_icon_t *) key)->surface) == 1)
+            g_hash_table_iter_remove(&iter);
+}
+
+/** Get a surface for an icon from _NET_WM_ICON. Identical icons share a
+ * surface, so that they are only decoded once.
+ * \param width The width of the icon.
+ * \param height The height of the icon.
+ * \param data The icon's pixels in ARGB format.
+ * \return A new reference to the surface.
+ */
+static cairo_surface_t *
+ewmh_icon_cache_get(uint32_t width, uint32_t height, uint32_t *data)
+{
+    size_t len = (size_t) width * height;
+    ewmh_icon_t key = { .width = width, .height = height, .data = data };
+    ewmh_icon_t *icon;
+    uint64_t hash = 0xcbf29ce484222325 ^ width ^ ((uint64_t) height << 32);
+
+    for(size_t i = 0; i < len; i++)
+        hash = (hash ^ data[i]) * 0x100000001b3;
+    key.hash = hash ^ (hash >> 32);
+
+    if(!ewmh_icon_cache)
+        ewmh_icon_cache = g_hash_table_new_full(ewmh_icon_hash, ewmh_icon_equal, ewmh_icon_free, NULL);
+
+    icon = g_hash_table_lookup(ewmh_icon_cache, &key);
+    if(icon)
+    {
+        ewmh_icon_cache_hits++;
+        return cairo_surface_reference(icon->surface);
+    }
+
+    ewmh_icon_cache_misses++;
+    ewmh_icon_cache_trim();
+
+    icon = p_new(ewmh_icon_t, 1);
+    *icon = key;
+    icon->data = p_dup(data, len);
+    icon->surface = draw_surface_from_data(width, height, data);
+    g_hash_table_add(ewmh_icon_cache, icon);
+
+    return cairo_surface_reference(icon->surface);
+}
+
+/** Get statistics about the cache of decoded _NET_WM_ICONs.
+ * \param hits Set to the number of icons that were found in the cache.
+ * \param misses Set to the number of icons that had to be decoded.
+ */
+void
+ewmh_get_icon_cache_stats(unsigned long *hits, unsigned long *misses)
+{
+    *hits = ewmh_icon_cache_hits;
+    *misses = ewmh_icon_cache_misses;
+}
+
 /** Send request to get NET_WM_ICON (EWMH)
+ * Only the beginning of the property is requested. When the property is
+ * larger, ewmh_window_icon_get_reply() fetches the rest that it needs.
  * \param w The window.
  * \return The cookie associated with the request.
  */
@@ -671,65 +795,117 @@ xcb_get_property_cookie_t
 ewmh_window_icon_get_unchecked(xcb_window_t w)
 {
   return xcb_get_property_unchecked(globalconf.connection, false, w,
-                                    _NET_WM_ICON, XCB_ATOM_CARDINAL, 0, UINT32_MAX);
+                                    _NET_WM_ICON, XCB_ATOM_CARDINAL, 0, EWMH_ICON_FIRST_CHUNK);
 }
 
-static cairo_surface_t *
-ewmh_window_icon_from_reply(xcb_get_property_reply_t *r, uint32_t preferred_size)
+/** Fetch a part of a window's NET_WM_ICON.
+ * \param w The window.
+ * \param offset The offset in 32 bit units.
+ * \param length The length in 32 bit units.
+ * \return The reply, or NULL if the property does not contain this part.
+ */
+static xcb_get_property_reply_t *
+ewmh_window_icon_get_range(xcb_window_t w, uint32_t offset, uint32_t length)
 {
-    uint32_t *data, *end, *found_data = 0;
-    uint32_t found_size = 0;
+    xcb_get_property_reply_t *r =
+        xcb_get_property_reply(globalconf.connection,
+                               xcb_get_property_unchecked(globalconf.connection, false, w,
+                                                          _NET_WM_ICON, XCB_ATOM_CARDINAL,
+                                                          offset, length),
+                               NULL);
+
+    if(!r || r->type != XCB_ATOM_CARDINAL || r->format != 32 || r->length < length)
+        p_delete(&r);
+
+    return r;
+}
+
+/** Get NET_WM_ICON.
+ * The icon that best matches the size preference is picked. In case the size
+ * match is not exact, the closest bigger size is picked if present, the
+ * closest smaller size otherwise. Only the headers of the icons and the
+ * pixels of the picked icon are transferred from the X server.
+ * \param w The window.
+ * \param cookie The cookie from ewmh_window_icon_get_unchecked().
+ * \param preferred_size The preferred size of the icon.
+ * \return The icon, or NULL.
+ */
+cairo_surface_t *
+ewmh_window_icon_get_reply(xcb_window_t w, xcb_get_property_cookie_t cookie, uint32_t preferred_size)
+{
+    xcb_get_property_reply_t *r = xcb_get_property_reply(globalconf.connection, cookie, NULL);
+    xcb_get_property_reply_t *part;
+    cairo_surface_t *surface = NULL;
+    uint32_t *data, *pixels;
+    uint32_t have, total, offset = 0;
+    uint32_t found_offset = 0, found_width = 0, found_height = 0, found_size = 0;
 
     if(!r || r->type != XCB_ATOM_CARDINAL || r->format != 32 || r->length < 2)
-        return 0;
+        goto out;
 
     data = (uint32_t *) xcb_get_property_value(r);
-    if (!data) return 0;
-
-    end = data + r->length;
+    if (!data)
+        goto out;
+
+    /* What we already have and the size of the whole property, in 32 bit units */
+    have = r->length;
+    total = have + r->bytes_after / 4;
+
+    while ((uint64_t) offset + 2 <= total) {
+        uint32_t width, height;
+
+        if (offset + 2 <= have) {
+            width = data[offset];
+            height = data[offset + 1];
+        } else {
+            /* Only fetch the header of this icon */
+            if (!(part = ewmh_window_icon_get_range(w, offset, 2)))
+                break;
+            width = ((uint32_t *) xcb_get_property_value(part))[0];
+            height = ((uint32_t *) xcb_get_property_value(part))[1];
+            p_delete(&part);
+        }
 
-    /* Goes over the icon data and picks the icon that best matches the size preference.
-     * In case the size match is not exact, picks the closest bigger size if present,
-     * closest smaller size otherwise.
-     */
-    while (data + 1 < end) {
-        /* check whether the data size specified by width and height fits into the array we got */
-        uint64_t data_size = (uint64_t) data[0] * data[1];
-        if (data_size > (uint64_t) (end - data - 2)) break;
+        /* check whether the data size specified by width and height fits into the property */
+        uint64_t data_size = (uint64_t) width * height;
+        if (data_size > (uint64_t) (total - offset - 2)) break;
 
         /* use the greater of the two dimensions to match against the preferred size */
-        uint32_t size = MAX(data[0], data[1]);
+        uint32_t size = MAX(width, height);
 
         /* pick the icon if it's a better match than the one we already have */
         bool found_icon_too_small = found_size < preferred_size;
         bool found_icon_too_large = found_size > preferred_size;
-        bool icon_empty = data[0] == 0 || data[1] == 0;
+        bool icon_empty = width == 0 || height == 0;
         bool better_because_bigger =  found_icon_too_small && size > found_size;
         bool better_because_smaller = found_icon_too_large &&
             size >= preferred_size && size < found_size;
         if (!icon_empty && (better_because_bigger || better_because_smaller || found_size == 0))
         {
-            found_data = data;
+            found_offset = offset;
+            found_width = width;
+            found_height = height;
             found_size = size;
         }
 
-        data += data_size + 2;
+        offset += data_size + 2;
     }
 
-    if (!found_data) return 0;
+    if (!found_size)
+        goto out;
 
-    return draw_surface_from_data(found_data[0], found_data[1], found_data + 2);
-}
+    if (found_offset + 2 + found_width * found_height <= have)
+        surface = ewmh_icon_cache_get(found_width, found_height, data + found_offset + 2);
+    else if ((part = ewmh_window_icon_get_range(w, found_offset, 2 + found_width * found_height)))
+    {
+        /* The header is fetched again in case the property changed meanwhile */
+        pixels = (uint32_t *) xcb_get_property_value(part);
+        if (pixels[0] == found_width && pixels[1] == found_height)
+            surface = ewmh_icon_cache_get(found_width, found_height, pixels + 2);
+        p_delete(&part);
+    }
 
-/** Get NET_WM_ICON.
- * \param cookie The cookie.
- * \return The number of elements on stack.
- */
-cairo_surface_t *
-ewmh_window_icon_get_reply(xcb_get_property_cookie_t cookie, uint32_t preferred_size)
-{
-    xcb_get_property_reply_t *r = xcb_get_property_reply(globalconf.connection, cookie, NULL);
-    cairo_surface_t *surface = ewmh_window_icon_from_reply(r, preferred_size);
+out:
     p_delete(&r);
     return surface;
 }
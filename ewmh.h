@@ -42,7 +42,8 @@ void ewmh_process_client_strut(client_t *);
 void ewmh_update_strut(xcb_window_t, strut_t *);
 void ewmh_update_window_type(xcb_window_t window, uint32_t type);
 xcb_get_property_cookie_t ewmh_window_icon_get_unchecked(xcb_window_t);
-cairo_surface_t *ewmh_window_icon_get_reply(xcb_get_property_cookie_t, uint32_t preferred_size);
+cairo_surface_t *ewmh_window_icon_get_reply(xcb_window_t, xcb_get_property_cookie_t, uint32_t preferred_size);
+void ewmh_get_icon_cache_stats(unsigned long *, unsigned long *);
 
 #endif
 // vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
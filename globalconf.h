@@ -115,6 +115,10 @@ typedef struct
     uint8_t event_base_randr;
     /** Clients list */
     client_array_t clients;
+    /** Clients with pending geometry or border changes */
+    client_array_t dirty_clients;
+    /** Index from X window ids to the clients and drawins using them */
+    GHashTable *windows;
     /** Embedded windows */
     xembed_window_array_t embedded;
     /** Stack client history */
@@ -197,6 +201,8 @@ typedef struct
     window_array_t destroy_later_windows;
     /** Pending event that still needs to be handled */
     xcb_generic_event_t *pending_event;
+    /** Number of events dropped because a later event superseded them */
+    unsigned long folded_events;
     /** The exit code that main() will return with */
     int exit_code;
 } awesome_t;
@@ -16,7 +16,9 @@ local table = table
 local math = math
 local print = print
 local pairs = pairs
+local ipairs = ipairs
 local string = string
+local setmetatable = setmetatable
 
 local completion = {}
 
@@ -196,6 +198,138 @@ function completion.generic(text, cur_pos, ncomp, keywords) -- luacheck: no unus
     return matches[ncomp], #matches[ncomp] + 1, matches
 end
 
+--- Check whether the characters of a query appear in order in a string.
+-- @tparam string str The string.
+-- @tparam table chars The characters of the query.
+-- @tparam number stop The position after the end of the part of the string
+--   to look at.
+-- @treturn boolean
+local function is_subsequence(str, chars, stop)
+    local pos = 1
+    for i = 1, #chars do
+        pos = str:find(chars[i], pos + 1, true)
+        if not pos or pos >= stop then
+            return false
+        end
+    end
+    return true
+end
+
+local index_methods = {}
+
+--- Get the items which might match a query, without looking at the results
+-- of previous searches.
+-- @tparam string query The lowercase query.
+-- @treturn table The candidate items.
+function index_methods:_candidates(query)
+    -- Each character of the query has to appear in a matching item, so the
+    -- smallest of their lists contains all matches
+    local best = self.items
+    for i = 1, #query do
+        local list = self._by_char[query:byte(i)]
+        if not list then
+            return {}
+        end
+        if #list < #best then
+            best = list
+        end
+    end
+    return best
+end
+
+--- Search the index.
+--
+-- Searching for a query that starts with the previous query only looks at
+-- the results of the previous search. The results of searches for shorter
+-- queries are kept, so removing characters from the query again is cheap.
+-- @tparam string query The query. Case is ignored.
+-- @treturn table The matching items, in the order they were given to
+--   `completion.index`.
+-- @treturn table A table mapping each matching item to its rank: 2 if the
+--   query is a prefix of one of its strings, 1 if it appears in one of them
+--   and 0 if its characters appear in order in the first one.
+--   Both tables belong to the index and must not be modified.
+-- @method search
+function index_methods:search(query)
+    query = query:lower()
+    local history = self._history
+    local last = history[#history]
+    while last and query:sub(1, #last.query) ~= last.query do
+        table.remove(history)
+        last = history[#history]
+    end
+    if last and last.query == query then
+        return last.matches, last.ranks
+    end
+
+    -- The strings of each item are saved as one string, with a newline in
+    -- front of each of them
+    local line_query = "\n" .. query
+    local chars = {}
+    for i = 1, #query do
+        chars[i] = query:sub(i, i)
+    end
+
+    local matches, ranks, count = {}, {}, 0
+    local candidates = last and last.matches or self:_candidates(query)
+    local strings, first_ends = self._strings, self._first_ends
+    for _, item in ipairs(candidates) do
+        local str = strings[item]
+        local rank
+        if str:find(query, 1, true) then
+            rank = str:find(line_query, 1, true) and 2 or 1
+        elseif is_subsequence(str, chars, first_ends[item]) then
+            rank = 0
+        end
+        if rank then
+            count = count + 1
+            matches[count] = item
+            ranks[item] = rank
+        end
+    end
+    table.insert(history, { query = query, matches = matches, ranks = ranks })
+    return matches, ranks
+end
+
+--- Create an index to search a list of items.
+--
+-- A query matches an item when it appears in one of the item's strings or
+-- when its characters appear in order in the first of them. Matching ignores
+-- case. The strings are only fetched when the index is built, so it has to be
+-- rebuilt when the items change.
+-- @tparam table items The items.
+-- @tparam function get_strings A function that is called with an item and
+--   returns a list of strings to search, most important first.
+-- @return The index. Use its `search` method to search it.
+-- @function awful.completion.index
+function completion.index(items, get_strings)
+    local strings, first_ends, by_char = {}, {}, {}
+    for _, item in ipairs(items) do
+        local str = ("\n" .. table.concat(get_strings(item), "\n")):lower()
+        local seen = {}
+        for i = 2, #str do
+            local c = str:byte(i)
+            if not seen[c] then
+                seen[c] = true
+                by_char[c] = by_char[c] or {}
+                table.insert(by_char[c], item)
+            end
+        end
+        strings[item] = str
+        first_ends[item] = str:find("\n", 2, true) or #str + 1
+    end
+
+    local index = { items = items, _strings = strings, _first_ends = first_ends,
+                    _by_char = by_char, _history = {} }
+    -- The empty query is a prefix of everything
+    local ranks = {}
+    for _, item in ipairs(items) do
+        ranks[item] = 2
+    end
+    index._history[1] = { query = "", matches = items, ranks = ranks }
+    return setmetatable(index, { __index = index_methods })
+end
+
 return completion
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
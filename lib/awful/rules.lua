@@ -14,6 +14,8 @@ local table = table
 local type = type
 local ipairs = ipairs
 local pairs = pairs
+local setmetatable = setmetatable
+local math = math
 local atag = require("awful.tag")
 local util = require("awful.util")
 local a_place = require("awful.placement")
@@ -159,18 +161,312 @@ function rules.matches(c, entry)
         (not rules.match(c, entry.except) and not rules.match_any(c, entry.except_any))
 end
 
+-- Compiled versions of the lists of rules given to matching_rules and
+-- matches_list, see compile()
+local compiled_rules = setmetatable({}, { __mode = "k" })
+-- Incremented by rules.invalidate(), see compile()
+local rules_generation = 0
+
+--- Make awful.rules notice rules that were changed in place.
+--
+-- Lists of rules are compiled when they are first used and the result is
+-- kept until the list is replaced or its length changes, so assigning a new
+-- `awful.rules.rules` or appending entries to it is noticed. After changing
+-- an entry of a list that was already used, for example its `rule` or
+-- `rule_any` table, or after replacing an entry, call this function.
+function rules.invalidate()
+    rules_generation = rules_generation + 1
+end
+
+--- Compile one part of a rule entry.
+-- @tab part The `rule`, `rule_any`, `except` or `except_any` table.
+-- @bool any Whether the values are lists of alternatives.
+-- @tab conditions The conditions of the compiled rules, by field and value.
+-- @treturn table|nil The list of conditions to test.
+local function compile_part(part, any, conditions)
+    if not part then return nil end
+    local result = {}
+    for field, values in pairs(part) do
+        conditions[field] = conditions[field] or {}
+        for _, value in ipairs(any and values or { values }) do
+            local condition = conditions[field][value]
+            if not condition then
+                condition = { field = field, value = value }
+                if type(value) == "string" then
+                    -- Strings without magic characters only need a plain
+                    -- search, and anchored ones a comparison
+                    local magic = "[%^%$%(%)%%%.%[%]%*%+%-%?]"
+                    local anchored = value:match("^%^(.*)%$$")
+                    if not value:find(magic) then
+                        condition.literal = value
+                    elseif anchored and not anchored:find(magic) then
+                        condition.literal, condition.exact = anchored, true
+                    end
+                end
+                conditions[field][value] = condition
+            end
+            table.insert(result, condition)
+        end
+    end
+    return result
+end
+
+--- Get the conditions of a compiled entry one of which has to be true for the
+-- entry to match, and which only compare with literal values.
+-- @tab ce The compiled entry.
+-- @treturn table|nil The conditions, or nil if there are none.
+local function entry_keys(ce)
+    local keys = {}
+    if ce.rule then
+        -- All of them have to match, so the longest one is enough
+        local key
+        for _, condition in ipairs(ce.rule) do
+            if condition.literal and (condition.exact or #condition.literal > 0)
+                    and (not key or #condition.literal > #key.literal) then
+                key = condition
+            end
+        end
+        if not key then
+            return nil
+        end
+        table.insert(keys, key)
+    end
+    for _, condition in ipairs(ce.rule_any or {}) do
+        if not condition.literal or (not condition.exact and #condition.literal == 0) then
+            return nil
+        end
+        table.insert(keys, condition)
+    end
+    return keys
+end
+
+--- Compile a list of rules.
+--
+-- Rules testing the same property for the same value share one condition, so
+-- that each condition and each property is only evaluated once per client.
+--
+-- Entries are indexed by the literal values one of which has to appear in the
+-- client's properties for them to match: the longest one of their `rule`
+-- part and all of their `rule_any` part. Anchored values like "^xterm$" are
+-- kept in buckets that are looked up with the property's value, others in
+-- buckets that are looked up with its substrings. Only the entries found
+-- there and those that cannot be indexed, for example because they use
+-- patterns, are tested.
+--
+-- The compiled list is cached until its length changes or
+-- `rules.invalidate` is called.
+-- @tab _rules The rules.
+-- @treturn table The compiled rules.
+local function compile(_rules)
+    local compiled = compiled_rules[_rules]
+    if compiled and compiled.generation == rules_generation and #compiled.entries == #_rules then
+        return compiled
+    end
+
+    local conditions = {}
+    compiled = { entries = {}, keys = {}, unkeyed = {}, generation = rules_generation }
+    for i, entry in ipairs(_rules) do
+        local ce = {
+            index = i,
+            entry = entry,
+            rule = compile_part(entry.rule, false, conditions),
+            rule_any = compile_part(entry.rule_any, true, conditions),
+            except = compile_part(entry.except, false, conditions),
+            except_any = compile_part(entry.except_any, true, conditions),
+        }
+        compiled.entries[i] = ce
+
+        -- Index the entry by the literal values that it can match through
+        local keys = entry_keys(ce)
+        for _, condition in ipairs(keys or {}) do
+            local field_keys = compiled.keys[condition.field]
+            if not field_keys then
+                field_keys = { substrings = {}, exact = {}, lengths = {}, has_length = {}, count = 0 }
+                compiled.keys[condition.field] = field_keys
+            end
+            local literal = condition.literal
+            local map = condition.exact and field_keys.exact or field_keys.substrings
+            if not map[literal] then
+                map[literal] = {}
+                if not condition.exact then
+                    field_keys.count = field_keys.count + 1
+                    if not field_keys.has_length[#literal] then
+                        field_keys.has_length[#literal] = true
+                        table.insert(field_keys.lengths, #literal)
+                    end
+                end
+            end
+            table.insert(map[literal], ce)
+        end
+        if not keys then
+            table.insert(compiled.unkeyed, ce)
+        end
+    end
+    compiled_rules[_rules] = compiled
+    return compiled
+end
+
+--- Read a property of a client, but only once per matching.
+-- @client c The client.
+-- @string field The property.
+-- @tab state The values of the properties and the results of the conditions
+--   that were already needed for this client.
+-- @return The value, false if it is not set.
+local function get_property(c, field, state)
+    local value = state[field]
+    if value == nil then
+        value = c[field] or false
+        state[field] = value
+    end
+    return value
+end
+
+--- Find the entries of compiled rules which might match a client. These are
+-- the entries that are not indexed and those whose key appears in the
+-- client's properties.
+-- @client c The client.
+-- @tab compiled The compiled rules.
+-- @tab state See get_property.
+-- @treturn table The compiled entries, in the order of the rules.
+local function find_candidates(c, compiled, state)
+    local candidates, found = {}, {}
+    local function add(entries)
+        for _, ce in ipairs(entries) do
+            if not found[ce] then
+                found[ce] = true
+                table.insert(candidates, ce)
+            end
+        end
+    end
+    for field, keys in pairs(compiled.keys) do
+        local value = get_property(c, field, state)
+        if type(value) == "string" then
+            local len = #value
+            if keys.exact[value] then
+                add(keys.exact[value])
+            end
+            -- Look up all substrings of the value with the length of a key, or
+            -- search the value for every key, whatever is less work
+            local lookups = 0
+            for _, l in ipairs(keys.lengths) do
+                lookups = lookups + math.max(len - l + 1, 0)
+            end
+            if lookups <= keys.count then
+                local substrings = keys.substrings
+                for _, l in ipairs(keys.lengths) do
+                    for start = 1, len - l + 1 do
+                        local entries = substrings[value:sub(start, start + l - 1)]
+                        if entries then
+                            add(entries)
+                        end
+                    end
+                end
+            else
+                for key, entries in pairs(keys.substrings) do
+                    if value:find(key, 1, true) then
+                        add(entries)
+                    end
+                end
+            end
+        end
+    end
+
+    -- Merge with the entries that are not indexed, keeping the order of the
+    -- rules
+    table.sort(candidates, function(a, b) return a.index < b.index end)
+    local result, unkeyed = {}, compiled.unkeyed
+    local i, j = 1, 1
+    while candidates[i] or unkeyed[j] do
+        if not unkeyed[j] or (candidates[i] and candidates[i].index < unkeyed[j].index) then
+            table.insert(result, candidates[i])
+            i = i + 1
+        else
+            table.insert(result, unkeyed[j])
+            j = j + 1
+        end
+    end
+    return result
+end
+
+--- Test a condition of a compiled rule, see `rules.match`.
+-- @client c The client.
+-- @tab condition The condition.
+-- @tab state See get_property.
+-- @treturn bool
+local function test_condition(c, condition, state)
+    local result = state[condition]
+    if result == nil then
+        local value = get_property(c, condition.field, state)
+        local expected = condition.value
+        if not value then
+            result = false
+        elseif value == expected then
+            result = true
+        elseif type(value) ~= "string" then
+            result = false
+        elseif condition.exact then
+            result = value == condition.literal
+        elseif condition.literal then
+            result = value:find(expected, 1, true) ~= nil
+        else
+            result = value:match(expected) ~= nil
+        end
+        state[condition] = result
+    end
+    return result
+end
+
+local function test_all(c, conditions, state)
+    for _, condition in ipairs(conditions) do
+        if not test_condition(c, condition, state) then
+            return false
+        end
+    end
+    return true
+end
+
+local function test_any(c, conditions, state)
+    for _, condition in ipairs(conditions) do
+        if test_condition(c, condition, state) then
+            return true
+        end
+    end
+    return false
+end
+
+--- Call a function for each entry of the compiled rules that matches a client,
+-- until it returns true.
+-- @client c The client.
+-- @tab _rules The rules.
+-- @tparam function f The function, called with the entry.
+local function foreach_matching(c, _rules, f)
+    local compiled = compile(_rules)
+    local state = {}
+    for _, ce in ipairs(find_candidates(c, compiled, state)) do
+        if ((ce.rule and test_all(c, ce.rule, state))
+                    or (ce.rule_any and test_any(c, ce.rule_any, state)))
+                and not (ce.except and test_all(c, ce.except, state))
+                and not (ce.except_any and test_any(c, ce.except_any, state))
+                and f(ce.entry) then
+            return
+        end
+    end
+end
+
 --- Get list of matching rules for a client.
+--
+-- The rules are compiled and cached. Each client property is only read once,
+-- even when many rules test it. Entries that are changed in place are only
+-- noticed after `awful.rules.invalidate` was called.
 -- @client c The client.
 -- @tab _rules The rules to check. List with "rule", "rule_any", "except" and
 --   "except_any" keys.
 -- @treturn table The list of matched rules.
 function rules.matching_rules(c, _rules)
     local result = {}
-    for _, entry in ipairs(_rules) do
-        if (rules.matches(c, entry)) then
-            table.insert(result, entry)
-        end
-    end
+    foreach_matching(c, _rules, function(entry)
+        table.insert(result, entry)
+    end)
     return result
 end
 
@@ -180,12 +476,12 @@ end
 --   `except` and `except_any` keys.
 -- @treturn bool True if at least one rule is matched, false otherwise.
 function rules.matches_list(c, _rules)
-    for _, entry in ipairs(_rules) do
-        if (rules.matches(c, entry)) then
-            return true
-        end
-    end
-    return false
+    local found = false
+    foreach_matching(c, _rules, function()
+        found = true
+        return true
+    end)
+    return found
 end
 
 --- Apply awful.rules.rules to a client.
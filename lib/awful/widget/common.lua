@@ -36,6 +36,46 @@ function common.create_buttons(buttons, object)
     end
 end
 
+--- Update the widgets of one object.
+-- @tab cache The widgets of the object, see `common.list_update`.
+-- @func label Function to generate label parameters from an object.
+-- @param o The object.
+-- @tab objects All displayed objects.
+-- @tparam number i The index of the object in objects.
+local function update_object(cache, label, o, objects, i)
+    local ib, tb, bgb, tbm, ibm = cache.ib, cache.tb, cache.bgb, cache.tbm, cache.ibm
+
+    local text, bg, bg_image, icon, args = label(o, tb)
+    args = args or {}
+
+    -- The text might be invalid, so use pcall.
+    if text == nil or text == "" then
+        tbm:set_margins(0)
+    else
+        if not tb:set_markup_silently(text) then
+            tb:set_markup("<i>&lt;Invalid text&gt;</i>")
+        end
+    end
+    bgb:set_bg(bg)
+    if type(bg_image) == "function" then
+        -- TODO: Why does this pass nil as an argument?
+        bg_image = bg_image(tb,o,nil,objects,i)
+    end
+    bgb:set_bgimage(bg_image)
+    if icon then
+        -- Setting the same image again would throw away its scaled copies
+        if ib:get_image() ~= icon then
+            ib:set_image(icon)
+        end
+    else
+        ibm:set_margins(0)
+    end
+
+    bgb.shape              = args.shape
+    bgb.shape_border_width = args.shape_border_width
+    bgb.shape_border_color = args.shape_border_color
+end
+
 --- Common update method.
 -- @param w The widget.
 -- @tab buttons
@@ -49,20 +89,13 @@ function common.list_update(w, buttons, label, data, objects)
     w:reset()
     for i, o in ipairs(objects) do
         local cache = data[o]
-        local ib, tb, bgb, tbm, ibm, l
-        if cache then
-            ib = cache.ib
-            tb = cache.tb
-            bgb = cache.bgb
-            tbm = cache.tbm
-            ibm = cache.ibm
-        else
-            ib = wibox.widget.imagebox()
-            tb = wibox.widget.textbox()
-            bgb = wibox.container.background()
-            tbm = wibox.container.margin(tb, dpi(4), dpi(4))
-            ibm = wibox.container.margin(ib, dpi(4))
-            l = wibox.layout.fixed.horizontal()
+        if not cache then
+            local ib = wibox.widget.imagebox()
+            local tb = wibox.widget.textbox()
+            local bgb = wibox.container.background()
+            local tbm = wibox.container.margin(tb, dpi(4), dpi(4))
+            local ibm = wibox.container.margin(ib, dpi(4))
+            local l = wibox.layout.fixed.horizontal()
 
             -- All of this is added in a fixed widget
             l:fill_space(true)
@@ -74,46 +107,37 @@ function common.list_update(w, buttons, label, data, objects)
 
             bgb:buttons(common.create_buttons(buttons, o))
 
-            data[o] = {
+            cache = {
                 ib  = ib,
                 tb  = tb,
                 bgb = bgb,
                 tbm = tbm,
                 ibm = ibm,
             }
+            data[o] = cache
         end
 
-        local text, bg, bg_image, icon, args = label(o, tb)
-        args = args or {}
-
-        -- The text might be invalid, so use pcall.
-        if text == nil or text == "" then
-            tbm:set_margins(0)
-        else
-            if not tb:set_markup_silently(text) then
-                tb:set_markup("<i>&lt;Invalid text&gt;</i>")
-            end
-        end
-        bgb:set_bg(bg)
-        if type(bg_image) == "function" then
-            -- TODO: Why does this pass nil as an argument?
-            bg_image = bg_image(tb,o,nil,objects,i)
-        end
-        bgb:set_bgimage(bg_image)
-        if icon then
-            ib:set_image(icon)
-        else
-            ibm:set_margins(0)
-        end
+        update_object(cache, label, o, objects, i)
 
-        bgb.shape              = args.shape
-        bgb.shape_border_width = args.shape_border_width
-        bgb.shape_border_color = args.shape_border_color
-
-        w:add(bgb)
+        w:add(cache.bgb)
    end
 end
 
+--- Update the widgets of a single object after `common.list_update`.
+-- This is much cheaper than calling `common.list_update` again, but only
+-- possible while the list of objects stays the same.
+-- @func label Function to generate label parameters from an object, see
+--   `common.list_update`.
+-- @tab data Current data/cache, indexed by objects.
+-- @tab objects The objects that were given to `common.list_update`.
+-- @tparam number i The index of the object to update in objects.
+function common.list_update_object(label, data, objects, i)
+    local o = objects[i]
+    if data[o] then
+        update_object(data[o], label, o, objects, i)
+    end
+end
+
 return common
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
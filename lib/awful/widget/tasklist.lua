@@ -41,6 +41,7 @@ local util = require("awful.util")
 local tag = require("awful.tag")
 local flex = require("wibox.layout.flex")
 local timer = require("gears.timer")
+local surface = require("gears.surface")
 
 local function get_screen(s)
     return s and screen[s]
@@ -50,6 +51,20 @@ local tasklist = { mt = {} }
 
 local instances
 
+-- The icons of the clients as cairo surfaces. c.icon creates a new surface on
+-- every access, which would make the icon widgets scale the icon again on each
+-- update.
+local client_icons = setmetatable({}, { __mode = "k" })
+
+local function client_icon(c)
+    local icon = client_icons[c]
+    if icon == nil then
+        icon = c.icon and surface(c.icon) or false
+        client_icons[c] = icon
+    end
+    return icon or nil
+end
+
 --- The default foreground (text) color.
 -- @beautiful beautiful.tasklist_fg_normal
 -- @tparam[opt=nil] string|pattern fg_normal
@@ -196,6 +211,15 @@ local instances
 -- Public structures
 tasklist.filter = {}
 
+--- Only update the entry of a client when one of its properties changes.
+--
+-- The whole tasklist is still rebuilt when the client appears in it or
+-- disappears from it. Set this to false if the filter of a tasklist depends
+-- on the properties of other clients than the one it is called with, or to
+-- always rebuild all tasklists.
+-- @tfield[opt=true] boolean incremental_updates
+tasklist.incremental_updates = true
+
 local function tasklist_label(c, args, tb)
     if not args then args = {} end
     local theme = beautiful.get()
@@ -334,15 +358,24 @@ local function tasklist_label(c, args, tb)
         shape_border_color = shape_border_color,
     }
 
-    return text, bg, bg_image, not tasklist_disable_icon and c.icon or nil, other_args
+    return text, bg, bg_image, not tasklist_disable_icon and client_icon(c) or nil, other_args
+end
+
+--- Does a tasklist show a client?
+-- @client c The client.
+-- @screen s The screen of the tasklist.
+-- @func filter The filter of the tasklist.
+-- @treturn boolean
+local function tasklist_shows(c, s, filter)
+    return not (c.skip_taskbar or c.hidden
+        or c.type == "splash" or c.type == "dock" or c.type == "desktop")
+        and filter(c, s) and true or false
 end
 
 local function tasklist_update(s, w, buttons, filter, data, style, update_function)
     local clients = {}
     for _, c in ipairs(capi.client.get()) do
-        if not (c.skip_taskbar or c.hidden
-            or c.type == "splash" or c.type == "dock" or c.type == "desktop")
-            and filter(c, s) then
+        if tasklist_shows(c, s, filter) then
             table.insert(clients, c)
         end
     end
@@ -350,6 +383,7 @@ local function tasklist_update(s, w, buttons, filter, data, style, update_functi
     local function label(c, tb) return tasklist_label(c, style, tb) end
 
     update_function(w, buttons, label, data, clients)
+    return clients
 end
 
 --- Create a new tasklist widget. The last two arguments (update_function
@@ -409,21 +443,71 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
         w:set_spacing(style and style.spacing or beautiful.tasklist_spacing)
     end
 
+    -- The clients shown by the last full update, and their positions
+    local shown_clients, shown_index = {}, {}
+    local function full_update()
+        shown_clients = tasklist_update(screen, w, buttons, filter, data, style, uf)
+        shown_index = {}
+        for i, c in ipairs(shown_clients) do
+            shown_index[c] = i
+        end
+    end
+
     local queued_update = false
+    -- Clients whose entry has to be updated, if no full update is queued
+    local queued_clients = nil
     function w._do_tasklist_update()
         -- Add a delayed callback for the first update.
         if not queued_update then
             timer.delayed_call(function()
                 queued_update = false
+                queued_clients = nil
                 if screen.valid then
-                    tasklist_update(screen, w, buttons, filter, data, style, uf)
+                    full_update()
                 end
             end)
             queued_update = true
         end
     end
+    local function update_clients()
+        local clients = queued_clients
+        queued_clients = nil
+        if queued_update or not clients or not screen.valid then
+            return
+        end
+        -- A client that appeared or disappeared needs a full update
+        for c in pairs(clients) do
+            if (shown_index[c] ~= nil) ~= tasklist_shows(c, screen, filter) then
+                full_update()
+                return
+            end
+        end
+        local function label(c, tb) return tasklist_label(c, style, tb) end
+        for c in pairs(clients) do
+            if shown_index[c] then
+                common.list_update_object(label, data, shown_clients, shown_index[c])
+            end
+        end
+    end
+    function w._do_client_update(c)
+        if queued_update then
+            return
+        end
+        if not tasklist.incremental_updates or uf ~= common.list_update then
+            w._do_tasklist_update()
+            return
+        end
+        if not queued_clients then
+            queued_clients = {}
+            timer.delayed_call(update_clients)
+        end
+        queued_clients[c] = true
+    end
     function w._unmanage(c)
         data[c] = nil
+        if queued_clients then
+            queued_clients[c] = nil
+        end
     end
     if instances == nil then
         instances = setmetatable({}, { __mode = "k" })
@@ -442,29 +526,55 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
                 end
             end
         end
+        -- Only the entry of the client changed, unless it now appears in
+        -- some tasklist or disappears from it
+        local function uc(c)
+            for s, i in pairs(instances) do
+                if s.valid then
+                    for _, tlist in pairs(i) do
+                        tlist._do_client_update(c)
+                    end
+                end
+            end
+        end
+        local function ufocus(c)
+            uc(c)
+            -- A transient that skips the taskbar highlights its parent
+            if c.skip_taskbar then
+                local parent = c:get_transient_for_matching(function(cl)
+                    return not cl.skip_taskbar
+                end)
+                if parent then
+                    uc(parent)
+                end
+            end
+        end
 
         tag.attached_connect_signal(nil, "property::selected", u)
         tag.attached_connect_signal(nil, "property::activated", u)
-        capi.client.connect_signal("property::urgent", u)
-        capi.client.connect_signal("property::sticky", u)
-        capi.client.connect_signal("property::ontop", u)
-        capi.client.connect_signal("property::above", u)
-        capi.client.connect_signal("property::below", u)
-        capi.client.connect_signal("property::floating", u)
-        capi.client.connect_signal("property::maximized_horizontal", u)
-        capi.client.connect_signal("property::maximized_vertical", u)
-        capi.client.connect_signal("property::minimized", u)
-        capi.client.connect_signal("property::name", u)
-        capi.client.connect_signal("property::icon_name", u)
-        capi.client.connect_signal("property::icon", u)
-        capi.client.connect_signal("property::skip_taskbar", u)
+        capi.client.connect_signal("property::urgent", uc)
+        capi.client.connect_signal("property::sticky", uc)
+        capi.client.connect_signal("property::ontop", uc)
+        capi.client.connect_signal("property::above", uc)
+        capi.client.connect_signal("property::below", uc)
+        capi.client.connect_signal("property::floating", uc)
+        capi.client.connect_signal("property::maximized_horizontal", uc)
+        capi.client.connect_signal("property::maximized_vertical", uc)
+        capi.client.connect_signal("property::minimized", uc)
+        capi.client.connect_signal("property::name", uc)
+        capi.client.connect_signal("property::icon_name", uc)
+        capi.client.connect_signal("property::icon", function(c)
+            client_icons[c] = nil
+            uc(c)
+        end)
+        capi.client.connect_signal("property::skip_taskbar", uc)
         capi.client.connect_signal("property::screen", function(c, old_screen)
             us(c.screen)
             us(old_screen)
         end)
-        capi.client.connect_signal("property::hidden", u)
-        capi.client.connect_signal("tagged", u)
-        capi.client.connect_signal("untagged", u)
+        capi.client.connect_signal("property::hidden", uc)
+        capi.client.connect_signal("tagged", uc)
+        capi.client.connect_signal("untagged", uc)
         capi.client.connect_signal("unmanage", function(c)
             u(c)
             for _, i in pairs(instances) do
@@ -474,8 +584,8 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
             end
         end)
         capi.client.connect_signal("list", u)
-        capi.client.connect_signal("focus", u)
-        capi.client.connect_signal("unfocus", u)
+        capi.client.connect_signal("focus", ufocus)
+        capi.client.connect_signal("unfocus", ufocus)
         capi.screen.connect_signal("removed", function(s)
             instances[get_screen(s)] = nil
         end)
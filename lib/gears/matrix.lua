@@ -12,6 +12,13 @@ local matrix = {}
 -- Metatable for matrix instances. This is set up near the end of the file.
 local matrix_mt = {}
 
+-- Number of matrix instances that were created so far
+local allocations = 0
+
+-- Released matrices that matrix.acquire() hands out again
+local pool, pool_size = {}, 0
+local pool_max = 64
+
 --- Create a new matrix instance
 -- @tparam number xx The xx transformation part.
 -- @tparam number yx The yx transformation part.
@@ -21,12 +28,52 @@ local matrix_mt = {}
 -- @tparam number y0 The y0 transformation part.
 -- @return A new matrix describing the given transformation.
 function matrix.create(xx, yx, xy, yy, x0, y0)
+    allocations = allocations + 1
     return setmetatable({
         xx = xx, xy = xy, x0 = x0,
         yx = yx, yy = yy, y0 = y0
     }, matrix_mt)
 end
 
+--- Get a matrix from the pool of released matrices.
+-- This works like @{matrix.create}, but reuses a matrix that was given back
+-- with @{matrix:release} when there is one. The result belongs to the caller,
+-- so it may be modified with the in-place functions like @{matrix:set}.
+-- @tparam number xx The xx transformation part.
+-- @tparam number yx The yx transformation part.
+-- @tparam number xy The xy transformation part.
+-- @tparam number yy The yy transformation part.
+-- @tparam number x0 The x0 transformation part.
+-- @tparam number y0 The y0 transformation part.
+-- @return A matrix describing the given transformation.
+function matrix.acquire(xx, yx, xy, yy, x0, y0)
+    if pool_size == 0 then
+        return matrix.create(xx, yx, xy, yy, x0, y0)
+    end
+    local ret = pool[pool_size]
+    pool[pool_size] = nil
+    pool_size = pool_size - 1
+    return ret:set(xx, yx, xy, yy, x0, y0)
+end
+
+--- Give a matrix back to the pool used by @{matrix.acquire}.
+-- The matrix must not be used anymore after this, neither by the caller nor
+-- by anything else that got a reference to it.
+function matrix:release()
+    assert(not rawequal(self, matrix.identity), "Cannot release the identity matrix")
+    if pool_size < pool_max then
+        pool_size = pool_size + 1
+        pool[pool_size] = self
+    end
+end
+
+--- Get the number of matrix instances that were created so far.
+-- Matrices handed out again by @{matrix.acquire} are not counted.
+-- @treturn number The number of matrices created.
+function matrix.get_allocations()
+    return allocations
+end
+
 --- Create a new translation matrix
 -- @tparam number x The translation in x direction.
 -- @tparam number y The translation in y direction.
@@ -62,6 +109,80 @@ function matrix.create_rotate_at(x, y, angle)
            * matrix.create_translate(  x,  y )
 end
 
+--- Change this matrix in place.
+-- Matrices are usually treated as values and the other functions return new
+-- instances. This and the other `_in_place` functions should only be used on
+-- matrices which are not referenced by anyone else, for example ones obtained
+-- via @{matrix.acquire}.
+-- @tparam number xx The xx transformation part.
+-- @tparam number yx The yx transformation part.
+-- @tparam number xy The xy transformation part.
+-- @tparam number yy The yy transformation part.
+-- @tparam number x0 The x0 transformation part.
+-- @tparam number y0 The y0 transformation part.
+-- @return This matrix.
+function matrix:set(xx, yx, xy, yy, x0, y0)
+    assert(not rawequal(self, matrix.identity), "Cannot modify the identity matrix")
+    self.xx, self.yx, self.xy, self.yy, self.x0, self.y0 = xx, yx, xy, yy, x0, y0
+    return self
+end
+
+--- Set a matrix to the product of two matrices.
+-- This is the in-place version of @{matrix:multiply}. The target may be the
+-- same matrix as one of the factors.
+-- @tparam gears.matrix target The matrix to modify, see @{matrix:set}.
+-- @tparam gears.matrix|cairo.Matrix a The first factor.
+-- @tparam gears.matrix|cairo.Matrix b The second factor.
+-- @return The target matrix.
+function matrix.multiply_into(target, a, b)
+    return target:set(a.xx * b.xx + a.yx * b.xy,
+        a.xx * b.yx + a.yx * b.yy,
+        a.xy * b.xx + a.yy * b.xy,
+        a.xy * b.yx + a.yy * b.yy,
+        a.x0 * b.xx + a.y0 * b.xy + b.x0,
+        a.x0 * b.yx + a.y0 * b.yy + b.y0)
+end
+
+--- Multiply this matrix with another matrix in place.
+-- See @{matrix:multiply} and @{matrix:set}.
+-- @tparam gears.matrix|cairo.Matrix other The other matrix to multiply with.
+-- @return This matrix.
+function matrix:multiply_in_place(other)
+    return matrix.multiply_into(self, self, other)
+end
+
+--- Translate this matrix in place.
+-- See @{matrix:translate} and @{matrix:set}.
+-- @tparam number x The translation in x direction.
+-- @tparam number y The translation in y direction.
+-- @return This matrix.
+function matrix:translate_in_place(x, y)
+    return self:set(self.xx, self.yx, self.xy, self.yy,
+        x * self.xx + y * self.xy + self.x0,
+        x * self.yx + y * self.yy + self.y0)
+end
+
+--- Scale this matrix in place.
+-- See @{matrix:scale} and @{matrix:set}.
+-- @tparam number sx The scaling in x direction.
+-- @tparam number sy The scaling in y direction.
+-- @return This matrix.
+function matrix:scale_in_place(sx, sy)
+    return self:set(sx * self.xx, sx * self.yx, sy * self.xy, sy * self.yy,
+        self.x0, self.y0)
+end
+
+--- Rotate this matrix in place.
+-- See @{matrix:rotate} and @{matrix:set}.
+-- @tparam number angle The angle of the rotation in radians.
+-- @return This matrix.
+function matrix:rotate_in_place(angle)
+    local c, s = math.cos(angle), math.sin(angle)
+    return self:set(c * self.xx + s * self.xy, c * self.yx + s * self.yy,
+        c * self.xy - s * self.xx, c * self.yy - s * self.yx,
+        self.x0, self.y0)
+end
+
 --- Translate this matrix
 -- @tparam number x The translation in x direction.
 -- @tparam number y The translation in y direction.
@@ -113,14 +234,12 @@ end
 -- @tparam gears.matrix|cairo.Matrix other The other matrix to multiply with.
 -- @return The multiplication result.
 function matrix:multiply(other)
-    local ret = matrix.create(self.xx * other.xx + self.yx * other.xy,
+    return matrix.create(self.xx * other.xx + self.yx * other.xy,
         self.xx * other.yx + self.yx * other.yy,
         self.xy * other.xx + self.yy * other.xy,
         self.xy * other.yx + self.yy * other.yy,
         self.x0 * other.xx + self.y0 * other.xy + other.x0,
         self.x0 * other.yx + self.y0 * other.yy + other.y0)
-
-    return ret
 end
 
 --- Check if two matrices are equal.
@@ -129,12 +248,9 @@ end
 -- @tparam gears.matrix|cairo.Matrix other The matrix to compare with.
 -- @return True if this and the other matrix are equal.
 function matrix:equals(other)
-    for _, k in pairs{ "xx", "xy", "yx", "yy", "x0", "y0" } do
-        if self[k] ~= other[k] then
-            return false
-        end
-    end
-    return true
+    return rawequal(self, other) or (self.xx == other.xx and self.xy == other.xy
+        and self.yx == other.yx and self.yy == other.yy
+        and self.x0 == other.x0 and self.y0 == other.y0)
 end
 
 --- Get a string representation of this matrix
@@ -176,11 +292,17 @@ end
 -- @treturn number Width of the bounding rectangle.
 -- @treturn number Height of the bounding rectangle.
 function matrix:transform_rectangle(x, y, width, height)
+    local xx, yx, xy, yy, x0, y0 = self.xx, self.yx, self.xy, self.yy, self.x0, self.y0
+    -- Pure translations are the common case and need no min/max
+    if xx == 1 and yx == 0 and xy == 0 and yy == 1 and width >= 0 and height >= 0 then
+        return x + x0, y + y0, width, height
+    end
+
     -- Transform all four corners of the rectangle
-    local x1, y1 = self:transform_point(x, y)
-    local x2, y2 = self:transform_point(x, y + height)
-    local x3, y3 = self:transform_point(x + width, y + height)
-    local x4, y4 = self:transform_point(x + width, y)
+    local x1, y1 = xx * x + xy * y + x0, yx * x + yy * y + y0
+    local x2, y2 = x1 + xy * height, y1 + yy * height
+    local x3, y3 = x2 + xx * width, y2 + yx * width
+    local x4, y4 = x1 + xx * width, y1 + yx * width
     -- Find the extremal points of the result
     x = math.min(x1, x2, x3, x4)
     y = math.min(y1, y2, y3, y4)
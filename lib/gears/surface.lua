@@ -20,6 +20,10 @@ end
 
 local surface = { mt = {} }
 local surface_cache = setmetatable({}, { __mode = 'v' })
+-- Scaled copies of surfaces, see surface.scaled()
+local scaled_cache = setmetatable({}, { __mode = 'k' })
+-- How many sizes of a surface are kept in scaled_cache
+local scaled_cache_sizes = 4
 
 local function get_default(arg)
     if type(arg) == 'nil' then
@@ -114,6 +118,35 @@ function surface.load(_surface)
     return do_load_and_handle_errors(_surface, surface.load_silently)
 end
 
+--- Load an image file without blocking.
+-- The image is decoded in a separate thread. The result is cached like with
+-- `load`, so a cached image is passed to the callback immediately.
+-- @tparam string path The file to load.
+-- @tparam function callback Function that is called with the loaded surface,
+--   or with nil and an error message.
+function surface.load_async(path, callback)
+    local cache = surface_cache[path]
+    if cache then
+        callback(cache)
+        return
+    end
+    capi.awesome.load_image_async(path, nil, function(result, err)
+        if not result then
+            callback(nil, err)
+            return
+        end
+        result = cairo.Surface(result, true)
+        -- A load that finished at the same time could have cached the file
+        cache = surface_cache[path]
+        if cache then
+            result = cache
+        else
+            surface_cache[path] = result
+        end
+        callback(result)
+    end)
+end
+
 function surface.mt.__call(_, ...)
     return surface.load(...)
 end
@@ -127,6 +160,52 @@ function surface.get_size(surf)
     return w - x, h - y
 end
 
+--- Get a copy of a surface that was scaled to the given size.
+-- The copies are kept while the source surface exists, so drawing an image at
+-- the same size again does not scale it again. When the source surface is
+-- modified afterwards, `surface.invalidate_scaled` has to be called.
+-- @param surf The surface to scale.
+-- @tparam integer width The width of the result, in device pixels.
+-- @tparam integer height The height of the result, in device pixels.
+-- @return A cairo image surface of the given size.
+function surface.scaled(surf, width, height)
+    local sizes = scaled_cache[surf]
+    if not sizes then
+        sizes = { count = 0 }
+        scaled_cache[surf] = sizes
+    end
+    local by_height = sizes[width]
+    local result = by_height and by_height[height]
+    if result then
+        return result
+    end
+
+    if sizes.count >= scaled_cache_sizes then
+        sizes = { count = 0 }
+        scaled_cache[surf] = sizes
+    end
+    by_height = sizes[width] or {}
+    sizes[width] = by_height
+    sizes.count = sizes.count + 1
+
+    local w, h = surface.get_size(surf)
+    result = cairo.ImageSurface(cairo.Format.ARGB32, width, height)
+    local cr = cairo.Context(result)
+    cr:scale(width / w, height / h)
+    cr:set_source_surface(surf, 0, 0)
+    cr:paint()
+    by_height[height] = result
+    return result
+end
+
+--- Forget the scaled copies of a surface.
+-- This has to be called when a surface that was given to `surface.scaled` is
+-- modified.
+-- @param surf The surface that was modified.
+function surface.invalidate_scaled(surf)
+    scaled_cache[surf] = nil
+end
+
 --- Create a copy of a cairo surface.
 -- The surfaces returned by `surface.load` are cached and must not be
 -- modified to avoid unintended side-effects. This function allows to create
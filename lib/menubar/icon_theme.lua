@@ -13,13 +13,17 @@
 local beautiful = require("beautiful")
 local awful_util = require("awful.util")
 local GLib = require("lgi").GLib
+local Gio = require("lgi").Gio
 local index_theme = require("menubar.index_theme")
 
 local ipairs = ipairs
+local pairs = pairs
 local setmetatable = setmetatable
 local string = string
 local table = table
 local math = math
+local io = io
+local os = os
 
 local get_pragmatic_base_directories = function()
     local dirs = {}
@@ -77,6 +81,137 @@ local icon_theme = { mt = {} }
 
 local index_theme_cache = {}
 
+--- The file in which the contents of the icon directories are saved between
+-- sessions. Set this to nil to not save them.
+icon_theme.cache_file = awful_util.get_cache_dir() .. "icon-theme-cache"
+
+-- Version of the format of the cache file
+local CACHE_VERSION = "awesome icon theme cache 1"
+
+-- How many seconds a directory listing is used before checking again whether
+-- the directory changed
+local LISTING_RECHECK_INTERVAL = 10
+
+-- Cached contents of directories. Maps a path to a table with the fields
+-- mtime (modification time of the directory in microseconds, -1 if it does
+-- not exist), files (set of readable file names) and checked (os.time() of
+-- the last time the mtime was compared).
+local dir_listings = nil
+-- Did dir_listings change since it was loaded from icon_theme.cache_file?
+local dir_listings_dirty = false
+
+local function get_dir_mtime(dir)
+    local info = Gio.File.new_for_path(dir):query_info("time::modified,time::modified-usec",
+                                                       Gio.FileQueryInfoFlags.NONE)
+    if not info then
+        return -1
+    end
+    return info:get_attribute_uint64("time::modified") * 1000000
+        + info:get_attribute_uint32("time::modified-usec")
+end
+
+local function scan_dir(dir)
+    local files = {}
+    local enum = Gio.File.new_for_path(dir):enumerate_children(
+        "standard::name,standard::type,access::can-read", Gio.FileQueryInfoFlags.NONE)
+    if not enum then
+        return files
+    end
+    while true do
+        local info = enum:next_file()
+        if not info then
+            break
+        end
+        local name = info:get_name()
+        -- Names with newlines or slashes cannot be saved in the cache file
+        if info:get_file_type() ~= "DIRECTORY" and info:get_attribute_boolean("access::can-read")
+                and not name:find("[\n/]") then
+            files[name] = true
+        end
+    end
+    enum:close()
+    return files
+end
+
+local function load_dir_listings()
+    dir_listings = {}
+    local f = icon_theme.cache_file and io.open(icon_theme.cache_file, "r")
+    if not f then
+        return
+    end
+    if f:read("*l") == CACHE_VERSION then
+        -- Each directory has a line with its mtime and path and a line with
+        -- the names of its files, separated by slashes
+        while true do
+            local header, names = f:read("*l"), f:read("*l")
+            if not header or not names then
+                break
+            end
+            local mtime, dir = header:match("^(-?%d+) (.*)$")
+            if mtime then
+                local files = {}
+                for name in names:gmatch("[^/]+") do
+                    files[name] = true
+                end
+                dir_listings[dir] = { mtime = tonumber(mtime), files = files, checked = 0 }
+            end
+        end
+    end
+    f:close()
+end
+
+local function save_dir_listings()
+    if not dir_listings_dirty or not icon_theme.cache_file then
+        return
+    end
+    dir_listings_dirty = false
+
+    local lines = { CACHE_VERSION }
+    for dir, listing in pairs(dir_listings) do
+        local names = {}
+        for name in pairs(listing.files) do
+            table.insert(names, name)
+        end
+        table.insert(lines, string.format("%d %s", listing.mtime, dir))
+        table.insert(lines, table.concat(names, "/"))
+    end
+    table.insert(lines, "")
+
+    local cache_file = icon_theme.cache_file
+    GLib.mkdir_with_parents(GLib.path_get_dirname(cache_file), tonumber("700", 8))
+    local f = io.open(cache_file .. ".tmp", "w")
+    if f then
+        f:write(table.concat(lines, "\n"))
+        f:close()
+        os.rename(cache_file .. ".tmp", cache_file)
+    end
+end
+
+--- Get the readable files in a directory, from the cache if possible.
+-- @tparam string dir The directory.
+-- @treturn table A set of file names.
+local function get_dir_listing(dir)
+    if not dir_listings then
+        load_dir_listings()
+    end
+    local now = os.time()
+    local listing = dir_listings[dir]
+    if listing and now - listing.checked < LISTING_RECHECK_INTERVAL then
+        return listing.files
+    end
+    local mtime = get_dir_mtime(dir)
+    if not listing or listing.mtime ~= mtime then
+        listing = { mtime = mtime, files = mtime == -1 and {} or scan_dir(dir) }
+        dir_listings[dir] = listing
+        dir_listings_dirty = true
+    end
+    listing.checked = now
+    return listing.files
+end
+
+-- The icons of each theme, see get_icon_index()
+local icon_index_cache = {}
+
 --- Class constructor of `icon_theme`
 -- @tparam string icon_theme_name Internal name of icon theme
 -- @tparam table base_directories Paths used for lookup
@@ -143,43 +278,95 @@ local directory_size_distance = function(self, subdirectory, icon_size)
     return 0xffffffff -- Any large number will do.
 end
 
-local lookup_icon = function(self, icon_name, icon_size)
-    local checked_already = {}
+--- Check if the directory listings an index was built from are still current.
+-- @tparam table listings Maps directories to the sets of files that were used.
+-- @treturn boolean
+local function listings_unchanged(listings)
+    for dir, files in pairs(listings) do
+        -- A changed directory gets a new listing
+        if get_dir_listing(dir) ~= files then
+            return false
+        end
+    end
+    return true
+end
+
+--- Get an index of all icons in a theme.
+-- The index maps icon names to lists of `{ subdir = ..., path = ... }` tables,
+-- in the order in which the icon theme specification says to look for them.
+-- It is built from the (cached) directory listings instead of probing for
+-- every possible file name, and only built again when one of them changed.
+local get_icon_index = function(self)
+    local key = table.concat({ self.icon_theme_name, table.concat(self.base_directories, ":"),
+                               table.concat(self.extensions, ":") }, "\0")
+    local cached = icon_index_cache[key]
+    if cached and os.time() - cached.checked < LISTING_RECHECK_INTERVAL then
+        return cached.index
+    end
+    if cached and listings_unchanged(cached.listings) then
+        cached.checked = os.time()
+        return cached.index
+    end
+
+    local ext_rank = {}
+    for i, ext in ipairs(self.extensions) do
+        ext_rank[ext] = i
+    end
+
+    local index, listings, order = {}, {}, 0
     for _, subdir in ipairs(self.index_theme:get_subdirectories()) do
         for _, basedir in ipairs(self.base_directories) do
-            for _, ext in ipairs(self.extensions) do
-                if directory_matches_size(self, subdir, icon_size) then
-                    local filename = string.format("%s/%s/%s/%s.%s",
-                                                   basedir, self.icon_theme_name, subdir,
-                                                   icon_name, ext)
-                    if awful_util.file_readable(filename) then
-                        return filename
-                    else
-                        checked_already[filename] = true
+            local dir = string.format("%s/%s/%s", basedir, self.icon_theme_name, subdir)
+            listings[dir] = get_dir_listing(dir)
+            for file in pairs(listings[dir]) do
+                local name, ext = file:match("^(.*)%.([^.]*)$")
+                local rank = ext and ext_rank[ext]
+                if rank then
+                    local list = index[name]
+                    if not list then
+                        list = {}
+                        index[name] = list
                     end
+                    table.insert(list, {
+                        subdir = subdir,
+                        path = dir .. "/" .. file,
+                        order = order + rank
+                    })
                 end
             end
+            order = order + #self.extensions
+        end
+    end
+    for _, list in pairs(index) do
+        if #list > 1 then
+            table.sort(list, function(a, b) return a.order < b.order end)
+        end
+    end
+
+    save_dir_listings()
+    icon_index_cache[key] = { index = index, listings = listings, checked = os.time() }
+    return index
+end
+
+local lookup_icon = function(self, icon_name, icon_size)
+    local candidates = get_icon_index(self)[icon_name]
+    if not candidates then
+        return nil
+    end
+
+    for _, candidate in ipairs(candidates) do
+        if directory_matches_size(self, candidate.subdir, icon_size) then
+            return candidate.path
         end
     end
 
     local minimal_size = 0xffffffff -- Any large number will do.
     local closest_filename = nil
-    for _, subdir in ipairs(self.index_theme:get_subdirectories()) do
-        local dist = directory_size_distance(self, subdir, icon_size)
+    for _, candidate in ipairs(candidates) do
+        local dist = directory_size_distance(self, candidate.subdir, icon_size)
         if dist < minimal_size then
-            for _, basedir in ipairs(self.base_directories) do
-                for _, ext in ipairs(self.extensions) do
-                    local filename = string.format("%s/%s/%s/%s.%s",
-                                                   basedir, self.icon_theme_name, subdir,
-                                                   icon_name, ext)
-                    if not checked_already[filename] then
-                        if awful_util.file_readable(filename) then
-                            closest_filename = filename
-                            minimal_size = dist
-                        end
-                    end
-                end
-            end
+            closest_filename = candidate.path
+            minimal_size = dist
         end
     end
     return closest_filename
@@ -205,15 +392,16 @@ end
 
 local lookup_fallback_icon = function(self, icon_name)
     for _, dir in ipairs(self.base_directories) do
+        local files = get_dir_listing(dir)
         for _, ext in ipairs(self.extensions) do
-            local filename = string.format("%s/%s.%s",
-                                           dir,
-                                           icon_name, ext)
-            if awful_util.file_readable(filename) then
-                return filename
+            local file = icon_name .. "." .. ext
+            if files[file] then
+                save_dir_listings()
+                return dir .. "/" .. file
             end
         end
     end
+    save_dir_listings()
     return nil
 end
 
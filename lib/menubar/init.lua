@@ -94,6 +94,8 @@ local previous_item = nil
 local current_category = nil
 local shownitems = nil
 local instance = nil
+-- The awful.completion.index of menubar.menu_entries
+local search_index = nil
 
 local common_args = { w = wibox.layout.fixed.horizontal(),
                       data = setmetatable({}, { __mode = 'kv' }) }
@@ -117,11 +119,19 @@ local function label(o)
     end
 end
 
+-- The contents of the count file, loaded when first needed
+local count_table_cache = nil
+
 local function load_count_table()
+    if count_table_cache then
+        return count_table_cache
+    end
+
     local count_file_name = awful.util.getdir("cache") .. "/menu_count_file"
 
     local count_file = io.open (count_file_name, "r")
     local count_table = {}
+    count_table_cache = count_table
 
     -- read weight file
     if count_file then
@@ -228,11 +238,27 @@ local function get_current_page(all_items, query, scr)
     return current_page
 end
 
+--- Get the strings that the query is searched in for a menu entry.
+-- @param o The menu entry.
+-- @treturn table The strings.
+local function get_search_strings(o)
+    local strings = { o.name }
+    for _, key in ipairs({ "cmdline", "generic_name", "keywords" }) do
+        if o[key] then
+            table.insert(strings, o[key])
+        end
+    end
+    return strings
+end
+
 --- Update the menubar according to the command entered by user.
 -- @tparam str query Search query.
 -- @tparam number|screen scr Screen
 local function menulist_update(query, scr)
     query = query or ""
+    for _, v in ipairs(shownitems or {}) do
+        v.focused = false
+    end
     shownitems = {}
     local pattern = awful.util.query_to_pattern(query)
 
@@ -283,36 +309,27 @@ local function menulist_update(query, scr)
         end
     end
 
-    -- Add the applications according to their name and cmdline
-    for _, v in ipairs(menubar.menu_entries) do
-        v.focused = false
+    -- Add the applications according to their name, cmdline, generic name
+    -- and keywords
+    if not search_index or search_index.items ~= menubar.menu_entries then
+        search_index = awful.completion.index(menubar.menu_entries, get_search_strings)
+    end
+    local matches, ranks = search_index:search(query)
+    for _, v in ipairs(matches) do
         if not current_category or v.category == current_category then
+            v.weight = 0
 
-            -- check if the query matches either the name or the commandline
-            -- of some entry
-            if string.match(v.name, pattern)
-                or string.match(v.cmdline, pattern) then
-
-                v.weight = 0
-                v.prio = PRIO_NONE
-
-                -- get use count from count_table if present
-                -- and use it as weight
-                if string.len(pattern) > 0 and count_table[v.name] ~= nil then
-                    v.weight = tonumber(count_table[v.name])
-                end
+            -- get use count from count_table if present
+            -- and use it as weight
+            if string.len(pattern) > 0 and count_table[v.name] ~= nil then
+                v.weight = tonumber(count_table[v.name])
+            end
 
-                -- check for prefix match
-                if string.match(v.name, "^" .. pattern)
-                    or string.match(v.cmdline, "^" .. pattern) then
-                    -- increase default priority
-                    v.prio = PRIO_NONE + 1
-                else
-                    v.prio = PRIO_NONE
-                end
+            -- prefix matches come first, entries that only match fuzzily
+            -- last
+            v.prio = PRIO_NONE + ranks[v] - 1
 
-                table.insert (command_list, v)
-            end
+            table.insert (command_list, v)
         end
     end
 
@@ -9,7 +9,9 @@
 -- Grab environment
 local utils = require("menubar.utils")
 local icon_theme = require("menubar.icon_theme")
+local beautiful = require("beautiful")
 local pairs = pairs
+local setmetatable = setmetatable
 local ipairs = ipairs
 local string = string
 local table = table
@@ -53,10 +55,19 @@ menu_gen.all_categories = {
                 icon_name = "applications-accessories", use = true }
 }
 
+-- What the icon of each category was looked up for
+local category_icons_for = setmetatable({}, { __mode = "k" })
+
 --- Find icons for category entries.
+-- Icons are only looked up again when the icon name or theme changed.
 function menu_gen.lookup_category_icons()
+    local theme = beautiful.icon_theme or ""
     for _, v in pairs(menu_gen.all_categories) do
-        v.icon = icon_theme():find_icon_path(v.icon_name)
+        local icon_for = theme .. "\0" .. (v.icon_name or "")
+        if category_icons_for[v] ~= icon_for then
+            v.icon = icon_theme():find_icon_path(v.icon_name)
+            category_icons_for[v] = icon_for
+        end
     end
 end
 
@@ -122,6 +133,8 @@ function menu_gen.generate(callback)
                             table.insert(result, { name = name,
                                          cmdline = cmdline,
                                          icon = icon,
+                                         generic_name = trim(entry.GenericName),
+                                         keywords = trim(entry.Keywords),
                                          category = target_category })
                             unique_entries[unique_key] = true
                         end
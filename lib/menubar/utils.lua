@@ -10,6 +10,7 @@
 local io = io
 local table = table
 local ipairs = ipairs
+local pairs = pairs
 local string = string
 local screen = screen
 local awful_util = require("awful.util")
@@ -20,6 +21,7 @@ local glib = lgi.GLib
 local wibox = require("wibox")
 local debug = require("gears.debug")
 local protected_call = require("gears.protected_call")
+local timer = require("gears.timer")
 
 local utils = {}
 
@@ -71,10 +73,13 @@ local function is_format_supported(icon_file)
 end
 
 local icon_lookup_path = nil
+-- The icon theme that icon_lookup_path was made for
+local icon_lookup_path_theme = nil
 --- Get a list of icon lookup paths.
 -- @treturn table A list of directories, without trailing slash.
 local function get_icon_lookup_path()
-    if not icon_lookup_path then
+    if not icon_lookup_path or icon_lookup_path_theme ~= theme.icon_theme then
+        icon_lookup_path_theme = theme.icon_theme
         local add_if_readable = function(t, path)
             if awful_util.dir_readable(path) then
                 table.insert(t, path)
@@ -118,6 +123,26 @@ local function get_icon_lookup_path()
     return icon_lookup_path
 end
 
+--- Get a stamp of the directories that icons are looked up in.
+-- It changes when the icon theme changes or when files are added to or
+-- removed from one of the directories, so that saved icon paths can be
+-- checked without looking up every icon again.
+-- @treturn string The stamp.
+local function get_icon_lookup_stamp()
+    local dirs = get_icon_lookup_path()
+    local attributes = gio.FILE_ATTRIBUTE_TIME_MODIFIED .. "," .. gio.FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+    local newest = 0
+    for _, dir in ipairs(dirs) do
+        local info = gio.File.new_for_path(dir):query_info(attributes, gio.FileQueryInfoFlags.NONE)
+        if info then
+            local mtime = info:get_attribute_uint64(gio.FILE_ATTRIBUTE_TIME_MODIFIED) * 1000000
+                + info:get_attribute_uint32(gio.FILE_ATTRIBUTE_TIME_MODIFIED_USEC)
+            newest = math.max(newest, mtime)
+        end
+    end
+    return string.format("%s %d %d", theme.icon_theme or "", #dirs, newest)
+end
+
 --- Lookup an icon in different folders of the filesystem.
 -- @tparam string icon_file Short or full name of the icon.
 -- @treturn string|boolean Full name of the icon, or false on failure.
@@ -152,24 +177,30 @@ function utils.lookup_icon_uncached(icon_file)
 end
 
 local lookup_icon_cache = {}
+-- The icon theme that lookup_icon_cache was filled with
+local lookup_icon_cache_theme = nil
 --- Lookup an icon in different folders of the filesystem (cached).
 -- @param icon Short or full name of the icon.
 -- @return full name of the icon.
 function utils.lookup_icon(icon)
+    if lookup_icon_cache_theme ~= theme.icon_theme then
+        lookup_icon_cache = {}
+        lookup_icon_cache_theme = theme.icon_theme
+    end
     if not lookup_icon_cache[icon] and lookup_icon_cache[icon] ~= false then
         lookup_icon_cache[icon] = utils.lookup_icon_uncached(icon)
     end
     return lookup_icon_cache[icon] or default_icon
 end
 
---- Parse a .desktop file.
--- @param file The .desktop file.
--- @return A table with file entries.
-function utils.parse_desktop_file(file)
-    local program = { show = true, file = file }
+--- Read the [Desktop Entry] group of a .desktop file.
+-- @tparam string file The .desktop file.
+-- @treturn table|nil The keys and values of the group, or nil if the file
+-- has no such group.
+local function read_desktop_file(file)
+    local keys = {}
     local desktop_entry = false
 
-    -- Parse the .desktop file.
     -- We are interested in [Desktop Entry] group only.
     for line in io.lines(file) do
         if line:find("^%s*#") then
@@ -185,7 +216,7 @@ function utils.parse_desktop_file(file)
 
             -- Grab the values
             for key, value in line:gmatch("(%w+)%s*=%s*(.+)") do
-                program[key] = value
+                keys[key] = value
             end
         end
     end
@@ -193,6 +224,22 @@ function utils.parse_desktop_file(file)
     -- In case [Desktop Entry] was not found
     if not desktop_entry then return nil end
 
+    return keys
+end
+
+--- Turn the keys of a .desktop file into a menu entry.
+-- @tparam string file The .desktop file.
+-- @tparam table keys The keys, as returned by read_desktop_file().
+-- @param icon_path The path of the icon, false if it was not found or nil
+-- to look it up.
+-- @return A table with file entries, or nil.
+-- @return The path of the icon, false if it was not found.
+local function make_program(file, keys, icon_path)
+    local program = { show = true, file = file }
+    for key, value in pairs(keys) do
+        program[key] = value
+    end
+
     -- In case the (required) 'Name' entry was not found
     if not program.Name or program.Name == '' then return nil end
 
@@ -209,7 +256,10 @@ function utils.parse_desktop_file(file)
 
     -- Look up for a icon.
     if program.Icon then
-        program.icon_path = utils.lookup_icon(program.Icon)
+        if icon_path == nil then
+            icon_path = utils.lookup_icon(program.Icon) or false
+        end
+        program.icon_path = icon_path or nil
     end
 
     -- Split categories into a table. Categories are written in one
@@ -241,20 +291,222 @@ function utils.parse_desktop_file(file)
         program.cmdline = cmdline
     end
 
-    return program
+    return program, icon_path
+end
+
+--- Parse a .desktop file.
+-- @param file The .desktop file.
+-- @return A table with file entries.
+function utils.parse_desktop_file(file)
+    local keys = read_desktop_file(file)
+    if not keys then return nil end
+    return (make_program(file, keys))
+end
+
+--- The file in which the parsed .desktop files are saved between sessions.
+-- Set this to nil to not save them.
+utils.desktop_cache_file = awful_util.get_cache_dir() .. "desktop-entry-cache"
+
+--- Watch the directories given to `parse_dir` for changes. Parsing a
+-- directory again then does not touch the disk unless something in it
+-- changed. When this is false, the directory is scanned every time and only
+-- new or modified .desktop files are parsed.
+utils.monitor_desktop_dirs = true
+
+-- Version of the format of the cache file
+local DESKTOP_CACHE_VERSION = "awesome desktop entry cache 2"
+
+-- Parsed .desktop files. Maps a path to a table with the fields mtime
+-- (modification time of the file in microseconds), keys (as returned by
+-- read_desktop_file()), icon_path (see make_program(), nil if not looked up
+-- yet), icon_theme (the icon theme that icon_path was looked up with),
+-- program (the menu entry, false if there is none) and program_for (the
+-- settings that the menu entry was made with).
+local desktop_entries = nil
+-- Did desktop_entries change since it was loaded from utils.desktop_cache_file?
+local desktop_entries_dirty = false
+-- The last scan of each directory given to parse_dir(). A table with the
+-- fields paths (the .desktop files that were found) and dirty (whether
+-- something changed since then).
+local dir_scans = {}
+-- The file monitors of all scanned directories
+local dir_monitors = {}
+
+local function load_desktop_entries()
+    desktop_entries = {}
+    local f = utils.desktop_cache_file and io.open(utils.desktop_cache_file, "r")
+    if not f then
+        return
+    end
+    if f:read("*l") == DESKTOP_CACHE_VERSION then
+        -- Icon paths are only valid as long as the icon theme and the icon
+        -- directories are unchanged
+        local same_icons = f:read("*l") == get_icon_lookup_stamp()
+        -- Each file has a line with its mtime and path, a line with its icon
+        -- path ("?" if not known) and a line per key, followed by an empty
+        -- line. Icons that were not found are not saved, so that they are
+        -- looked up again once they might have been installed.
+        while true do
+            local header, icon_path = f:read("*l"), f:read("*l")
+            if not header or not icon_path then
+                break
+            end
+            local keys, has_keys = {}, false
+            for line in f:lines() do
+                if line == "" then
+                    break
+                end
+                local key, value = line:match("^(%w+)=(.*)$")
+                if key then
+                    keys[key], has_keys = value, true
+                end
+            end
+            local mtime, path = header:match("^(%d+) (.*)$")
+            if mtime then
+                if icon_path == "?" or not same_icons then
+                    icon_path = nil
+                end
+                desktop_entries[path] = { mtime = tonumber(mtime),
+                                          keys = has_keys and keys or nil,
+                                          icon_path = icon_path,
+                                          icon_theme = theme.icon_theme }
+            end
+        end
+    end
+    f:close()
+end
+
+local function save_desktop_entries()
+    if not desktop_entries_dirty or not utils.desktop_cache_file then
+        return
+    end
+    desktop_entries_dirty = false
+
+    local lines = { DESKTOP_CACHE_VERSION, get_icon_lookup_stamp() }
+    for path, entry in pairs(desktop_entries) do
+        if not path:find("\n") then
+            table.insert(lines, string.format("%d %s", entry.mtime, path))
+            if entry.icon_path and entry.icon_theme == theme.icon_theme then
+                table.insert(lines, entry.icon_path)
+            else
+                table.insert(lines, "?")
+            end
+            for key, value in pairs(entry.keys or {}) do
+                table.insert(lines, key .. "=" .. value)
+            end
+            table.insert(lines, "")
+        end
+    end
+
+    local cache_file = utils.desktop_cache_file
+    glib.mkdir_with_parents(glib.path_get_dirname(cache_file), tonumber("700", 8))
+    local f = io.open(cache_file .. ".tmp", "w")
+    if f then
+        f:write(table.concat(lines, "\n"))
+        f:close()
+        os.rename(cache_file .. ".tmp", cache_file)
+    end
+end
+
+--- Get the menu entry of a parsed .desktop file.
+-- @tparam string path The .desktop file.
+-- @tparam table entry Its entry in desktop_entries.
+-- @return A table with file entries, or nil.
+local function get_program(path, entry)
+    if not entry.keys then
+        return nil
+    end
+    -- The Exec line, the visibility and the icon depend on these settings
+    local program_for = utils.terminal .. "\0" .. utils.wm_name
+        .. "\0" .. (theme.icon_theme or "")
+    if entry.program == nil or entry.program_for ~= program_for then
+        if entry.icon_theme ~= theme.icon_theme then
+            entry.icon_path = nil
+            entry.icon_theme = theme.icon_theme
+        end
+        local program, icon_path = make_program(path, entry.keys, entry.icon_path)
+        if icon_path ~= nil and icon_path ~= entry.icon_path then
+            entry.icon_path = icon_path
+            -- Icons that were not found are not saved
+            desktop_entries_dirty = desktop_entries_dirty or icon_path ~= false
+        end
+        entry.program = program or false
+        entry.program_for = program_for
+    end
+    return entry.program or nil
+end
+
+local function get_programs(paths)
+    local programs = {}
+    for _, path in ipairs(paths) do
+        local entry = desktop_entries[path]
+        local program = entry and get_program(path, entry)
+        if program then
+            table.insert(programs, program)
+        end
+    end
+    return programs
+end
+
+--- Watch a directory, so that the scans that contain it are redone after it
+-- changed.
+-- @tparam string dir The directory.
+-- @treturn boolean Whether the directory is being watched.
+local function monitor_dir(dir)
+    if not utils.monitor_desktop_dirs then
+        return false
+    end
+    if dir_monitors[dir] then
+        return true
+    end
+    local monitor = gio.File.new_for_path(dir):monitor_directory(gio.FileMonitorFlags.NONE)
+    if not monitor then
+        return false
+    end
+    monitor.on_changed:connect(function()
+        for scanned_dir, scan in pairs(dir_scans) do
+            if dir:sub(1, #scanned_dir) == scanned_dir then
+                scan.dirty = true
+            end
+        end
+    end)
+    dir_monitors[dir] = monitor
+    return true
 end
 
 --- Parse a directory with .desktop files recursively.
+--
+-- Parsed files are remembered (also in `utils.desktop_cache_file`), so only
+-- new and modified files are parsed again. See also
+-- `utils.monitor_desktop_dirs`.
 -- @tparam string dir_path The directory path.
 -- @tparam function callback Will be fired when all the files were parsed
 -- with the resulting list of menu entries as argument.
 -- @tparam table callback.programs Paths of found .desktop files.
 function utils.parse_dir(dir_path, callback)
+    local scan = dir_scans[dir_path]
+    if scan and scan.paths and not scan.dirty then
+        -- Nothing changed since the last scan. The callback is still called
+        -- later, like it is after a scan.
+        timer.delayed_call(callback, get_programs(scan.paths))
+        return
+    end
 
-    local function parser(dir, programs)
+    if not desktop_entries then
+        load_desktop_entries()
+    end
+    scan = { dirty = false }
+    dir_scans[dir_path] = scan
+    local seen = {}
+
+    local function parser(dir, paths)
+        if not monitor_dir(dir) then
+            scan.dirty = true
+        end
         local f = gio.File.new_for_path(dir)
         -- Except for "NONE" there is also NOFOLLOW_SYMLINKS
         local query = gio.FILE_ATTRIBUTE_STANDARD_NAME .. "," .. gio.FILE_ATTRIBUTE_STANDARD_TYPE
+            .. "," .. gio.FILE_ATTRIBUTE_TIME_MODIFIED .. "," .. gio.FILE_ATTRIBUTE_TIME_MODIFIED_USEC
         local enum, err = f:async_enumerate_children(query, gio.FileQueryInfoFlags.NONE)
         if not enum then
             debug.print_error(err)
@@ -271,12 +523,21 @@ function utils.parse_dir(dir_path, callback)
                 local file_type = info:get_file_type()
                 local file_path = enum:get_child(info):get_path()
                 if file_type == 'REGULAR' then
-                    local program = utils.parse_desktop_file(file_path)
-                    if program then
-                        table.insert(programs, program)
+                    local mtime = info:get_attribute_uint64(gio.FILE_ATTRIBUTE_TIME_MODIFIED) * 1000000
+                        + info:get_attribute_uint32(gio.FILE_ATTRIBUTE_TIME_MODIFIED_USEC)
+                    local entry = desktop_entries[file_path]
+                    if not entry or entry.mtime ~= mtime then
+                        -- New or modified file
+                        entry = { mtime = mtime, keys = read_desktop_file(file_path) }
+                        desktop_entries[file_path] = entry
+                        desktop_entries_dirty = true
+                    end
+                    seen[file_path] = true
+                    if entry.keys then
+                        table.insert(paths, file_path)
                     end
                 elseif file_type == 'DIRECTORY' then
-                    parser(file_path, programs)
+                    parser(file_path, paths)
                 end
             end
             if #list == 0 then
@@ -287,9 +548,22 @@ function utils.parse_dir(dir_path, callback)
     end
 
     gio.Async.start(function()
-        local result = {}
-        parser(dir_path, result)
-        protected_call.call(callback, result)
+        local paths = {}
+        parser(dir_path, paths)
+
+        -- Forget the files that were removed
+        local prefix = dir_path:gsub("/*$", "/")
+        for path in pairs(desktop_entries) do
+            if not seen[path] and path:sub(1, #prefix) == prefix then
+                desktop_entries[path] = nil
+                desktop_entries_dirty = true
+            end
+        end
+
+        scan.paths = paths
+        local programs = get_programs(paths)
+        save_desktop_entries()
+        protected_call.call(callback, programs)
     end)()
 end
 
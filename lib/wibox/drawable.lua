@@ -101,9 +101,12 @@ local function do_redraw(self)
     if self._dirty_area:is_empty() then
         return
     end
+    -- Only the dirty parts have to be made visible afterwards
+    local dirty_rects = {}
     for i = 0, self._dirty_area:num_rectangles() - 1 do
         local rect = self._dirty_area:get_rectangle(i)
         cr:rectangle(rect.x, rect.y, rect.width, rect.height)
+        dirty_rects[i + 1] = { x = rect.x, y = rect.y, width = rect.width, height = rect.height }
     end
     self._dirty_area = cairo.Region.create()
     cr:clip()
@@ -151,7 +154,7 @@ local function do_redraw(self)
         self._widget_hierarchy:draw(context, cr)
     end
 
-    self.drawable:refresh()
+    self.drawable:refresh(dirty_rects)
 
     assert(cr.status == "SUCCESS", "Cairo context entered error state: " .. cr.status)
 end
@@ -173,7 +176,7 @@ local function find_widgets(_drawable, result, _hierarchy, x, y)
     local width, height = _hierarchy:get_size()
     if x1 >= 0 and y1 >= 0 and x1 <= width and y1 <= height then
         -- Get the extents of this widget in the device space
-        local x3, y3, w3, h3 = matrix.transform_rectangle(_hierarchy:get_matrix_to_device(),
+        local x3, y3, w3, h3 = matrix.transform_rectangle(_hierarchy._matrix_to_device,
             0, 0, width, height)
         table.insert(result, {
             x = x3, y = y3, width = w3, height = h3,
@@ -433,7 +436,9 @@ function drawable.new(d, widget_context_skeleton, drawable_name)
         if ret._widget_hierarchy_callback_arg ~= arg then
             return
         end
-        local m = hierar:get_matrix_to_device()
+        -- Not get_matrix_to_device(), that would keep the hierarchy from
+        -- updating its matrix in place
+        local m = hierar._matrix_to_device
         local x, y, width, height = matrix.transform_rectangle(m, hierar:get_draw_extents())
         local x1, y1 = math.floor(x), math.floor(y)
         local x2, y2 = math.ceil(x + width), math.ceil(y + height)
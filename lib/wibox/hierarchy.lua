@@ -20,6 +20,8 @@ local function hierarchy_new(redraw_callback, layout_callback, callback_arg)
     local result = {
         _matrix = matrix.identity,
         _matrix_to_device = matrix.identity,
+        -- Is _matrix_to_device only referenced by us, so that we may modify it?
+        _matrix_to_device_owned = false,
         _need_update = true,
         _widget = nil,
         _context = nil,
@@ -70,13 +72,32 @@ local function hierarchy_new(redraw_callback, layout_callback, callback_arg)
     return result
 end
 
+-- A child hierarchy is no longer used, so its area needs a redraw
+local function remove_child(child, region)
+    local x, y, w, h = matrix.transform_rectangle(child._matrix_to_device, child:get_draw_extents())
+    region:union_rectangle(cairo.RectangleInt{
+        x = x, y = y, width = w, height = h
+    })
+    child._parent = nil
+    if child._matrix_to_device_owned then
+        child._matrix_to_device:release()
+        child._matrix_to_device = matrix.identity
+        child._matrix_to_device_owned = false
+    end
+end
+
+-- The matrix to the device is computed in here before it is known whether it
+-- changed. If it did, this matrix is swapped with the hierarchy's old one.
+local scratch_matrix = matrix.acquire(1, 0, 0, 1, 0, 0)
+
 local hierarchy_update
-function hierarchy_update(self, context, widget, width, height, region, matrix_to_parent, matrix_to_device)
+function hierarchy_update(self, context, widget, width, height, region, matrix_to_parent, parent_to_device)
+    local matrix_to_device = matrix.multiply_into(scratch_matrix, matrix_to_parent, parent_to_device)
+    local device_unchanged = matrix.equals(self._matrix_to_device, matrix_to_device)
     if (not self._need_update) and self._widget == widget and
             self._context == context and
             self._size.width == width and self._size.height == height and
-            matrix.equals(self._matrix, matrix_to_parent) and
-            matrix.equals(self._matrix_to_device, matrix_to_device) then
+            matrix.equals(self._matrix, matrix_to_parent) and device_unchanged then
         -- Nothing changed
         return
     end
@@ -106,7 +127,14 @@ function hierarchy_update(self, context, widget, width, height, region, matrix_t
     self._size.width = width
     self._size.height = height
     self._matrix = matrix_to_parent
-    self._matrix_to_device = matrix_to_device
+    if not device_unchanged then
+        if self._matrix_to_device_owned then
+            scratch_matrix, self._matrix_to_device = self._matrix_to_device, matrix_to_device
+        else
+            scratch_matrix, self._matrix_to_device = matrix.acquire(1, 0, 0, 1, 0, 0), matrix_to_device
+            self._matrix_to_device_owned = true
+        end
+    end
 
     -- Connect signals
     if old_widget ~= widget then
@@ -115,45 +143,91 @@ function hierarchy_update(self, context, widget, width, height, region, matrix_t
         widget:weak_connect_signal("widget::emit_recursive", self._emit_recursive)
     end
 
-    -- Update children
-    local old_children = self._children
+    -- Update children. As long as the children are the same widgets in the
+    -- same order, the existing child hierarchies are updated in place.
+    -- Otherwise, they are matched up with the new children by their widget.
+    -- A child whose widget is gone is reused for a new widget at its place.
+    local children = self._children
+    local old_count = #children
+    local by_widget, old_at, wanted
     local layout_result = base.layout_widget(no_parent, context, widget, width, height)
-    self._children = {}
-    for _, w in ipairs(layout_result or {}) do
-        local r = table.remove(old_children, 1)
+    local count = layout_result and #layout_result or 0
+    for i = 1, count do
+        local w = layout_result[i]
+        local r
+        if not by_widget then
+            r = children[i]
+            if r and r._widget ~= w._widget then
+                -- Something moved, index the remaining old children
+                by_widget, old_at, wanted = {}, {}, {}
+                for j = i, count do
+                    wanted[layout_result[j]._widget] = true
+                end
+                for j = i, old_count do
+                    local child = children[j]
+                    local list = by_widget[child._widget]
+                    if not list then
+                        list = {}
+                        by_widget[child._widget] = list
+                    end
+                    table.insert(list, child)
+                    old_at[j] = child
+                    children[j] = nil
+                end
+                r = nil
+            end
+        end
+        if by_widget then
+            local list = by_widget[w._widget]
+            r = list and table.remove(list, 1)
+            local old = old_at[i]
+            if not r and old and not wanted[old._widget] then
+                list = by_widget[old._widget]
+                for k, child in ipairs(list) do
+                    if child == old then
+                        r = table.remove(list, k)
+                        break
+                    end
+                end
+            end
+        end
         if not r then
             r = hierarchy_new(self._redraw_callback, self._layout_callback, self._callback_arg)
             r._parent = self
         end
-        hierarchy_update(r, context, w._widget, w._width, w._height, region, w._matrix, w._matrix * matrix_to_device)
-        table.insert(self._children, r)
+        hierarchy_update(r, context, w._widget, w._width, w._height, region, w._matrix, self._matrix_to_device)
+        children[i] = r
+    end
+
+    -- Check which part needs to be redrawn
+
+    -- Are there any children which were removed? Their area needs a redraw.
+    if by_widget then
+        for _, list in pairs(by_widget) do
+            for _, child in ipairs(list) do
+                remove_child(child, region)
+            end
+        end
+    else
+        for i = count + 1, old_count do
+            remove_child(children[i], region)
+            children[i] = nil
+        end
     end
 
     -- Calculate the draw extents
     local x1, y1, x2, y2 = 0, 0, width, height
-    for _, h in ipairs(self._children) do
+    for i = 1, count do
+        local h = children[i]
         local px, py, pwidth, pheight = matrix.transform_rectangle(h._matrix, h:get_draw_extents())
         x1 = math.min(x1, px)
         y1 = math.min(y1, py)
         x2 = math.max(x2, px + pwidth)
         y2 = math.max(y2, py + pheight)
     end
-    self._draw_extents = {
-        x = x1, y = y1,
-        width = x2 - x1,
-        height = y2 - y1
-    }
-
-    -- Check which part needs to be redrawn
-
-    -- Are there any children which were removed? Their area needs a redraw.
-    for _, child in ipairs(old_children) do
-        local x, y, w, h = matrix.transform_rectangle(child._matrix_to_device, child:get_draw_extents())
-        region:union_rectangle(cairo.RectangleInt{
-            x = x, y = y, width = w, height = h
-        })
-        child._parent = nil
-    end
+    local extents = self._draw_extents
+    extents.x, extents.y = x1, y1
+    extents.width, extents.height = x2 - x1, y2 - y1
 
     -- Did we change and need to be redrawn?
     local x, y, w, h = matrix.transform_rectangle(self._matrix_to_device, 0, 0, self._size.width, self._size.height)
@@ -197,7 +271,8 @@ end
 --   argument or a new, internally created region).
 function hierarchy:update(context, widget, width, height, region)
     region = region or cairo.Region.create()
-    hierarchy_update(self, context, widget, width, height, region, self._matrix, self._matrix_to_device)
+    local parent_to_device = self._parent and self._parent._matrix_to_device or matrix.identity
+    hierarchy_update(self, context, widget, width, height, region, self._matrix, parent_to_device)
     return region
 end
 
@@ -218,6 +293,8 @@ end
 -- hierarchy is applied upon) from this hierarchy's coordinate system.
 -- @return A matrix describing the transformation.
 function hierarchy:get_matrix_to_device()
+    -- The caller might keep the matrix, so we may no longer modify it
+    self._matrix_to_device_owned = false
     return self._matrix_to_device
 end
 
@@ -234,8 +311,7 @@ end
 -- hierarchy is applied upon) into this hierarchy's coordinate system.
 -- @return A matrix describing the transformation.
 function hierarchy:get_matrix_from_device()
-    local m = self:get_matrix_to_device()
-    return m:invert()
+    return self._matrix_to_device:invert()
 end
 
 --- Get the extents that this hierarchy possibly draws to (in the current coordinate space).
@@ -278,7 +354,12 @@ function hierarchy:draw(context, cr)
     end
 
     cr:save()
-    cr:transform(self:get_matrix_to_parent():to_cairo_matrix())
+    local m = self:get_matrix_to_parent()
+    if m.xx == 1 and m.yx == 0 and m.xy == 0 and m.yy == 1 then
+        cr:translate(m.x0, m.y0)
+    else
+        cr:transform(m:to_cairo_matrix())
+    end
 
     -- Clip to the draw extents
     cr:rectangle(self:get_draw_extents())
@@ -21,6 +21,8 @@ local align = {}
 -- @param height The available height.
 function align:layout(context, width, height)
     local result = {}
+    local placements = self._private.placements or {}
+    self._private.placements = placements
 
     -- Draw will have to deal with all three align modes and should work in a
     -- way that makes sense if one or two of the widgets are missing (if they
@@ -46,7 +48,7 @@ function align:layout(context, width, height)
         -- if all the space is taken, skip the rest, and draw just the middle
         -- widget
         if size_second >= size_remains then
-            return { base.place_widget_at(self._private.second, 0, 0, width, height) }
+            return { base.place_widget_at_cached(placements, "second", self._private.second, 0, 0, width, height) }
         else
             -- the middle widget is sized first, the outside widgets are given
             --  the remaining space if available we will draw later
@@ -84,7 +86,7 @@ function align:layout(context, width, height)
                 w = size_remains
             end
         end
-        table.insert(result, base.place_widget_at(self._private.first, 0, 0, w, h))
+        table.insert(result, base.place_widget_at_cached(placements, "first", self._private.first, 0, 0, w, h))
     end
     -- size_remains will be <= 0 if first used all the space
     if self._private.third and size_remains > 0 then
@@ -110,7 +112,7 @@ function align:layout(context, width, height)
             end
         end
         local x, y = width - w, height - h
-        table.insert(result, base.place_widget_at(self._private.third, x, y, w, h))
+        table.insert(result, base.place_widget_at_cached(placements, "third", self._private.third, x, y, w, h))
     end
     -- here we either draw the second widget in the space set aside for it
     -- in the beginning, or in the remaining space, if it is "inside"
@@ -134,7 +136,7 @@ function align:layout(context, width, height)
                 x = floor( (width -w)/2 )
             end
         end
-        table.insert(result, base.place_widget_at(self._private.second, x, y, w, h))
+        table.insert(result, base.place_widget_at_cached(placements, "second", self._private.second, x, y, w, h))
     end
     return result
 end
@@ -23,6 +23,8 @@ local fixed = {}
 function fixed:layout(context, width, height)
     local result = {}
     local pos,spacing = 0, self._private.spacing
+    local placements = self._private.placements or {}
+    self._private.placements = placements
 
     for k, v in pairs(self._private.widgets) do
         local x, y, w, h, _
@@ -46,7 +48,12 @@ function fixed:layout(context, width, height)
             (self._private.dir ~= "y" and pos-spacing > width) then
             break
         end
-        table.insert(result, base.place_widget_at(v, x, y, w, h))
+        table.insert(result, base.place_widget_at_cached(placements, #result + 1, v, x, y, w, h))
+    end
+
+    -- Forget placements of widgets which are no longer shown
+    for k = #result + 1, #placements do
+        placements[k] = nil
     end
     return result
 end
@@ -52,6 +52,8 @@ local flex = {}
 function flex:layout(_, width, height)
     local result = {}
     local pos,spacing = 0, self._private.spacing
+    local placements = self._private.placements or {}
+    self._private.placements = placements
     local num = #self._private.widgets
     local total_spacing = (spacing*(num-1))
 
@@ -76,7 +78,7 @@ function flex:layout(_, width, height)
             w, h = floor(space_per_item), height
         end
 
-        table.insert(result, base.place_widget_at(v, x, y, w, h))
+        table.insert(result, base.place_widget_at_cached(placements, #result + 1, v, x, y, w, h))
 
         pos = pos + space_per_item + spacing
 
@@ -86,6 +88,11 @@ function flex:layout(_, width, height)
         end
     end
 
+    -- Forget placements of widgets which are no longer shown
+    for k = #result + 1, #placements do
+        placements[k] = nil
+    end
+
     return result
 end
 
@@ -418,6 +418,32 @@ function base.place_widget_at(widget, x, y, width, height)
     return base.place_widget_via_matrix(widget, matrix.create_translate(x, y), width, height)
 end
 
+--- Create widget placement information like `place_widget_at`, but reuse the
+-- placement from an earlier layout when the widget did not move. Layouts with
+-- many children use this to avoid creating a new placement and matrix for
+-- every child on every relayout.
+-- @tparam table cache A table in which the layout keeps its placements.
+-- @param slot The key of this placement in `cache`, e.g. the child index.
+-- @tparam widget widget The widget that should be placed.
+-- @tparam number x The x coordinate for the widget.
+-- @tparam number y The y coordinate for the widget.
+-- @tparam number width The width of the widget in its own coordinate system.
+-- @tparam number height The height of the widget in its own coordinate system.
+-- @treturn table An opaque object that can be returned from `:layout()`.
+-- @function wibox.widget.base.place_widget_at_cached
+function base.place_widget_at_cached(cache, slot, widget, x, y, width, height)
+    local placement = cache[slot]
+    -- The cache only contains placements with a translation matrix
+    if placement and placement._widget == widget and
+            placement._width == width and placement._height == height and
+            placement._matrix.x0 == x and placement._matrix.y0 == y then
+        return placement
+    end
+    placement = base.place_widget_at(widget, x, y, width, height)
+    cache[slot] = placement
+    return placement
+end
+
 -- Read the table, separate attributes from widgets.
 local function parse_table(t, leave_empty)
     local max = 0
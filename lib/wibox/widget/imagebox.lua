@@ -18,13 +18,13 @@ local imagebox = { mt = {} }
 
 -- Draw an imagebox with the given cairo context in the given geometry.
 function imagebox:draw(_, cr, width, height)
-    if not self._private.image then return end
+    local image = self._private.image
+    if not image then return end
     if width == 0 or height == 0 then return end
 
+    local w, h = image:get_width(), image:get_height()
     if not self._private.resize_forbidden then
         -- Let's scale the image so that it fits into (width, height)
-        local w = self._private.image:get_width()
-        local h = self._private.image:get_height()
         local aspect = width / w
         local aspect_h = height / h
         if aspect > aspect_h then aspect = aspect_h end
@@ -37,7 +37,20 @@ function imagebox:draw(_, cr, width, height)
         cr:clip(self._private.clip_shape(cr, width, height, unpack(self._private.clip_args)))
     end
 
-    cr:set_source_surface(self._private.image, 0, 0)
+    -- Instead of scaling the image on every redraw, paint a copy that already
+    -- has the size that the image has on the device
+    if not self._private.resize_forbidden then
+        local m = cr.matrix
+        if m.xy == 0 and m.yx == 0 then
+            local device_w, device_h = math.floor(w * m.xx + 0.5), math.floor(h * m.yy + 0.5)
+            if device_w > 0 and device_h > 0 and (device_w ~= w or device_h ~= h) then
+                cr:scale(w / device_w, h / device_h)
+                image = surface.scaled(image, device_w, device_h)
+            end
+        end
+    end
+
+    cr:set_source_surface(image, 0, 0)
     cr:paint()
 end
 
@@ -103,6 +116,9 @@ function imagebox:set_image(image)
 
     if self._private.image == image then
         -- The image could have been modified, so better redraw
+        if image then
+            surface.invalidate_scaled(image)
+        end
         self:emit_signal("widget::redraw_needed")
         return
     end
@@ -123,6 +139,12 @@ end
 -- @see gears.shape
 -- @see set_clip_shape
 
+--- Get the image of this imagebox.
+-- @return The image as a cairo surface, or nil.
+function imagebox:get_image()
+    return self._private.image
+end
+
 --- Set a clip shape for this imagebox
 -- A clip shape define an area where the content is displayed and one where it
 -- is trimmed.
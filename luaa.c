@@ -40,6 +40,7 @@
 #include "objects/drawin.h"
 #include "objects/screen.h"
 #include "objects/tag.h"
+#include "profile.h"
 #include "property.h"
 #include "selection.h"
 #include "spawn.h"
@@ -295,6 +296,29 @@ luaA_load_image(lua_State *L)
     return 1;
 }
 
+/** Load an image from a given path without blocking.
+ *
+ * The image is decoded in a separate thread. Afterwards, the callback is
+ * called from the main loop. Loading the same file with the same size again
+ * before the first load finished does not decode it twice.
+ *
+ * @tparam string name The file name.
+ * @tparam[opt=0] integer size The maximum width and height of the result. The
+ *   image is scaled down while keeping its aspect ratio. 0 means the image's
+ *   own size.
+ * @tparam function callback The function to call with a cairo surface as
+ *   light user datum, or with nil and an error message.
+ * @function load_image_async
+ */
+static int
+luaA_load_image_async(lua_State *L)
+{
+    const char *filename = luaL_checkstring(L, 1);
+    int size = luaA_optinteger_range(L, 2, 0, 0, INT_MAX);
+    draw_load_image_async(L, filename, size, 3);
+    return 0;
+}
+
 /** Set the preferred size for client icons.
  *
  * The closest equal or bigger size is picked if present, otherwise the closest
@@ -405,6 +429,18 @@ luaA_fixups(lua_State *L)
  * @tfield string icon_path
  */
 
+/**
+ * The number of signal emits which were skipped because nothing was
+ * connected to the signal.
+ * @tfield integer skipped_signal_emits
+ */
+
+/**
+ * The number of X events which were not handled because a later event of
+ * the same kind superseded them.
+ * @tfield integer folded_events
+ */
+
 static int
 luaA_awesome_index(lua_State *L)
 {
@@ -474,6 +510,18 @@ luaA_awesome_index(lua_State *L)
         return 1;
     }
 
+    if(A_STREQ(buf, "skipped_signal_emits"))
+    {
+        lua_pushnumber(L, signal_get_skipped_emits());
+        return 1;
+    }
+
+    if(A_STREQ(buf, "folded_events"))
+    {
+        lua_pushnumber(L, globalconf.folded_events);
+        return 1;
+    }
+
     return luaA_default_index(L);
 }
 
@@ -518,7 +566,7 @@ luaA_awesome_disconnect_signal(lua_State *L)
 static int
 luaA_awesome_emit_signal(lua_State *L)
 {
-    signal_object_emit(L, &global_signals, luaL_checkstring(L, 1), lua_gettop(L) - 1);
+    signal_object_emit_id(L, &global_signals, luaA_checksignal(L, 1), lua_gettop(L) - 1);
     return 0;
 }
 
@@ -764,6 +812,7 @@ luaA_init(xdgHandle* xdg, string_array_t *searchpath)
         { "emit_signal", luaA_awesome_emit_signal },
         { "systray", luaA_systray },
         { "load_image", luaA_load_image },
+        { "load_image_async", luaA_load_image_async },
         { "set_preferred_icon_size", luaA_set_preferred_icon_size },
         { "register_xproperty", luaA_register_xproperty },
         { "set_xproperty", luaA_set_xproperty },
@@ -776,6 +825,7 @@ luaA_init(xdgHandle* xdg, string_array_t *searchpath)
         { "xrdb_get_value", luaA_xrdb_get_value},
         { "kill", luaA_kill},
         { "sync", luaA_sync},
+        { "stats", luaA_profile_stats},
         { NULL, NULL }
     };
 
@@ -985,7 +1035,7 @@ void
 luaA_emit_refresh()
 {
     lua_State *L = globalconf_get_lua_State();
-    signal_object_emit(L, &global_signals, "refresh", 0);
+    signal_object_emit_id(L, &global_signals, SIGNAL_ID("refresh"), 0);
 }
 
 int
@@ -373,6 +373,8 @@
 /**
  * The client icon.
  *
+ * Each read of this property returns a new copy of the icon.
+ *
  * **Signal:**
  *
  *  * *property::icon*
@@ -856,7 +858,7 @@ client_set_urgent(lua_State *L, int cidx, bool urgent)
         if(c->prop != value) \
         { \
             c->prop = value; \
-            luaA_object_emit_signal(L, cidx, "property::" #prop, 0); \
+            luaA_object_emit_signal_id(L, cidx, SIGNAL_ID("property::" #prop), 0); \
         } \
     }
 DO_CLIENT_SET_PROPERTY(group_window)
@@ -878,7 +880,7 @@ DO_CLIENT_SET_PROPERTY(skip_taskbar)
         } \
         p_delete(&c->prop); \
         c->prop = value; \
-        luaA_object_emit_signal(L, cidx, "property::" #signal, 0); \
+        luaA_object_emit_signal_id(L, cidx, SIGNAL_ID("property::" #signal), 0); \
     }
 #define DO_CLIENT_SET_STRING_PROPERTY(prop) \
         DO_CLIENT_SET_STRING_PROPERTY2(prop, prop)
@@ -952,21 +954,13 @@ client_on_selected_tags(client_t *c)
 client_t *
 client_getbywin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_INDEX_CLIENT);
 }
 
 client_t *
 client_getbynofocuswin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->nofocus_window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_INDEX_CLIENT_NOFOCUS);
 }
 
 /** Get a client by its frame window.
@@ -976,11 +970,7 @@ client_getbynofocuswin(xcb_window_t w)
 client_t *
 client_getbyframewin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->frame_window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_INDEX_CLIENT_FRAME);
 }
 
 /** Unfocus a client (internal).
@@ -1140,6 +1130,7 @@ client_get_nofocus_window(client_t *c)
                           0, NULL);
         xcb_map_window(globalconf.connection, c->nofocus_window);
         xwindow_grabkeys(c->nofocus_window, &c->keys);
+        window_index_add(c->nofocus_window, WINDOW_INDEX_CLIENT_NOFOCUS, (window_t *) c);
     }
     return c->nofocus_window;
 }
@@ -1177,10 +1168,22 @@ client_focus_refresh(void)
                         win, globalconf.timestamp);
 }
 
+/** Remember that a client's geometry or border has to be sent to X.
+ * \param c The client.
+ */
+void
+client_mark_dirty(client_t *c)
+{
+    if(c->dirty)
+        return;
+    c->dirty = true;
+    client_array_append(&globalconf.dirty_clients, c);
+}
+
 static void
 client_border_refresh(void)
 {
-    foreach(c, globalconf.clients)
+    foreach(c, globalconf.dirty_clients)
         window_border_refresh((window_t *) *c);
 }
 
@@ -1188,7 +1191,7 @@ static void
 client_geometry_refresh(void)
 {
     bool ignored_enterleave = false;
-    foreach(_c, globalconf.clients)
+    foreach(_c, globalconf.dirty_clients)
     {
         client_t *c = *_c;
 
@@ -1268,6 +1271,11 @@ client_refresh(void)
 {
     client_geometry_refresh();
     client_border_refresh();
+
+    foreach(c, globalconf.dirty_clients)
+        (*c)->dirty = false;
+    globalconf.dirty_clients.len = 0;
+
     client_focus_refresh();
 }
 
@@ -1380,6 +1388,7 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
     client_t *c = client_new(L);
     xcb_screen_t *s = globalconf.screen;
     c->border_width_callback = (void (*) (void *, uint16_t, uint16_t)) border_width_callback;
+    c->border_need_update_callback = (void (*) (void *)) client_mark_dirty;
 
     /* consider the window banned */
     c->isbanned = true;
@@ -1444,6 +1453,9 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
     /* Duplicate client and push it in client list */
     lua_pushvalue(L, -1);
     client_array_push(&globalconf.clients, luaA_object_ref(L, -1));
+    window_index_add(c->window, WINDOW_INDEX_CLIENT, (window_t *) c);
+    window_index_add(c->frame_window, WINDOW_INDEX_CLIENT_FRAME, (window_t *) c);
+    client_mark_dirty(c);
 
     /* Set the right screen */
     screen_client_moveto(c, screen_getbycoord(wgeom->x, wgeom->y), false);
@@ -1664,25 +1676,26 @@ client_resize_do(client_t *c, area_t geometry)
     /* Also store geometry including border */
     area_t old_geometry = c->geometry;
     c->geometry = geometry;
+    client_mark_dirty(c);
 
     luaA_object_push(L, c);
     if (!AREA_EQUAL(old_geometry, geometry))
-        luaA_object_emit_signal(L, -1, "property::geometry", 0);
+        luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::geometry"), 0);
     if (old_geometry.x != geometry.x || old_geometry.y != geometry.y)
     {
-        luaA_object_emit_signal(L, -1, "property::position", 0);
+        luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::position"), 0);
         if (old_geometry.x != geometry.x)
-            luaA_object_emit_signal(L, -1, "property::x", 0);
+            luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::x"), 0);
         else
-            luaA_object_emit_signal(L, -1, "property::y", 0);
+            luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::y"), 0);
     }
     if (old_geometry.width != geometry.width || old_geometry.height != geometry.height)
     {
-        luaA_object_emit_signal(L, -1, "property::size", 0);
+        luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::size"), 0);
         if (old_geometry.width != geometry.width)
-            luaA_object_emit_signal(L, -1, "property::width", 0);
+            luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::width"), 0);
         else
-            luaA_object_emit_signal(L, -1, "property::height", 0);
+            luaA_object_emit_signal_id(L, -1, SIGNAL_ID("property::height"), 0);
     }
     lua_pop(L, 1);
 
@@ -2126,7 +2139,19 @@ client_unmanage(client_t *c, bool window_valid)
             client_array_remove(&globalconf.clients, elem);
             break;
         }
+    window_index_remove(c->window);
+    window_index_remove(c->frame_window);
+    window_index_remove(c->nofocus_window);
     stack_client_remove(c);
+    stack_forget_window(c->frame_window);
+    if(c->dirty)
+        foreach(elem, globalconf.dirty_clients)
+            if(*elem == c)
+            {
+                client_array_remove(&globalconf.dirty_clients, elem);
+                break;
+            }
+    c->dirty = false;
     for(int i = 0; i < globalconf.tags.len; i++)
         untag_client(c, globalconf.tags.tab[i]);
 
@@ -2292,11 +2317,26 @@ luaA_client_isvisible(lua_State *L)
  */
 void
 client_set_icon(client_t *c, cairo_surface_t *s)
+{
+    if (s)
+        s = draw_dup_image_surface(s);
+    client_set_icon_shared(c, s);
+    if (s)
+        cairo_surface_destroy(s);
+}
+
+/** Set a client icon without copying it.
+ * The icon may be shared with other clients, so it must not be modified.
+ * \param c The client to change.
+ * \param s The icon, this function takes its own reference.
+ */
+void
+client_set_icon_shared(client_t *c, cairo_surface_t *s)
 {
     lua_State *L = globalconf_get_lua_State();
 
     if (s)
-        s = draw_dup_image_surface(s);
+        s = cairo_surface_reference(s);
     if(c->icon)
         cairo_surface_destroy(c->icon);
     c->icon = s;
@@ -2653,10 +2693,11 @@ client_refresh_titlebar_partial(client_t *c, client_titlebar_t bar, int16_t x, i
 
 #define HANDLE_TITLEBAR_REFRESH(name, index)                                                \
 static void                                                                                 \
-client_refresh_titlebar_ ## name(client_t *c)                                               \
+client_refresh_titlebar_ ## name(client_t *c, area_t changed)                               \
 {                                                                                           \
     area_t area = titlebar_get_area(c, index);                                              \
-    client_refresh_titlebar_partial(c, index, area.x, area.y, area.width, area.height);     \
+    client_refresh_titlebar_partial(c, index, area.x + changed.x, area.y + changed.y,       \
+                                    changed.width, changed.height);                         \
 }
 HANDLE_TITLEBAR_REFRESH(top, CLIENT_TITLEBAR_TOP)
 HANDLE_TITLEBAR_REFRESH(right, CLIENT_TITLEBAR_RIGHT)
@@ -3053,8 +3094,9 @@ luaA_client_get_icon(lua_State *L, client_t *c)
 {
     if(!c->icon)
         return 0;
-    /* lua gets its own reference which it will have to destroy */
-    lua_pushlightuserdata(L, cairo_surface_reference(c->icon));
+    /* The icon may be shared with other clients, so Lua gets a copy which it
+     * can modify and which it will have to destroy */
+    lua_pushlightuserdata(L, draw_dup_image_surface(c->icon));
     return 1;
 }
 
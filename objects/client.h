@@ -66,6 +66,8 @@ struct client_t
     area_t x11_frame_geometry;
     /** Got a configure request and have to call client_send_configure() if its ignored? */
     bool got_configure_request;
+    /** Is this client in globalconf.dirty_clients? */
+    bool dirty;
     /** Startup ID */
     char *startup_id;
     /** True if the client is sticky */
@@ -158,6 +160,7 @@ void client_ban_unfocus(client_t *);
 void client_unban(client_t *);
 void client_manage(xcb_window_t, xcb_get_geometry_reply_t *, xcb_get_window_attributes_reply_t *);
 bool client_resize(client_t *, area_t, bool);
+void client_mark_dirty(client_t *);
 void client_unmanage(client_t *, bool);
 void client_kill(client_t *);
 void client_set_sticky(lua_State *, int, bool);
@@ -183,6 +186,7 @@ void client_set_name(lua_State *L, int, char *);
 void client_set_alt_name(lua_State *L, int, char *);
 void client_set_group_window(lua_State *, int, xcb_window_t);
 void client_set_icon(client_t *, cairo_surface_t *);
+void client_set_icon_shared(client_t *, cairo_surface_t *);
 void client_set_icon_from_pixmaps(client_t *, xcb_pixmap_t, xcb_pixmap_t);
 void client_set_skip_taskbar(lua_State *, int, bool);
 void client_focus(client_t *);
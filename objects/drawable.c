@@ -106,6 +106,100 @@ static lua_class_t drawable_class;
 
 LUA_OBJECT_FUNCS(drawable_class, drawable_t, drawable)
 
+/** A pixmap that no drawable uses anymore */
+typedef struct
+{
+    xcb_pixmap_t pixmap;
+    uint16_t width, height;
+} drawable_pooled_pixmap_t;
+
+/** Maximum number of unused pixmaps that are kept for reuse */
+#define DRAWABLE_POOL_SIZE 4
+
+static drawable_pooled_pixmap_t drawable_pool[DRAWABLE_POOL_SIZE];
+static int drawable_pool_len;
+
+/** Number of size changes that could reuse a pixmap or had to create one */
+static unsigned long drawable_pool_hits, drawable_pool_misses;
+
+/** Get the statistics of the pixmap pool.
+ * \param hits Set to the number of size changes that reused a pixmap.
+ * \param misses Set to the number of size changes that created a pixmap.
+ */
+void
+drawable_get_pool_stats(unsigned long *hits, unsigned long *misses)
+{
+    *hits = drawable_pool_hits;
+    *misses = drawable_pool_misses;
+}
+
+/** Check if a pixmap can be used for some size without wasting too much.
+ * \param pixmap_width The width of the pixmap.
+ * \param pixmap_height The height of the pixmap.
+ * \param width The wanted width.
+ * \param height The wanted height.
+ * \return True if the pixmap can be used.
+ */
+static bool
+drawable_pixmap_fits(uint16_t pixmap_width, uint16_t pixmap_height,
+                     uint16_t width, uint16_t height)
+{
+    /* Don't keep a pixmap that is more than four times as large as needed */
+    return width <= pixmap_width && height <= pixmap_height
+        && (uint32_t) width * height * 4 >= (uint32_t) pixmap_width * pixmap_height;
+}
+
+/** Keep a pixmap that is no longer used for later reuse.
+ * \param pixmap The pixmap.
+ * \param width The width of the pixmap.
+ * \param height The height of the pixmap.
+ */
+static void
+drawable_pool_put(xcb_pixmap_t pixmap, uint16_t width, uint16_t height)
+{
+    if (drawable_pool_len == DRAWABLE_POOL_SIZE)
+    {
+        /* Forget the oldest pixmap */
+        xcb_free_pixmap(globalconf.connection, drawable_pool[0].pixmap);
+        memmove(drawable_pool, drawable_pool + 1,
+                sizeof(*drawable_pool) * (DRAWABLE_POOL_SIZE - 1));
+        drawable_pool_len--;
+    }
+    drawable_pool[drawable_pool_len++] = (drawable_pooled_pixmap_t)
+    {
+        .pixmap = pixmap,
+        .width = width,
+        .height = height
+    };
+}
+
+/** Get an unused pixmap that can be used for some size.
+ * \param width The wanted width.
+ * \param height The wanted height.
+ * \return The smallest fitting pixmap which is removed from the pool, or NULL.
+ */
+static drawable_pooled_pixmap_t *
+drawable_pool_take(uint16_t width, uint16_t height)
+{
+    static drawable_pooled_pixmap_t taken;
+    int best = -1;
+
+    for (int i = 0; i < drawable_pool_len; i++)
+        if (drawable_pixmap_fits(drawable_pool[i].width, drawable_pool[i].height, width, height)
+            && (best < 0 || (uint32_t) drawable_pool[i].width * drawable_pool[i].height
+                            < (uint32_t) drawable_pool[best].width * drawable_pool[best].height))
+            best = i;
+
+    if (best < 0)
+        return NULL;
+
+    taken = drawable_pool[best];
+    memmove(drawable_pool + best, drawable_pool + best + 1,
+            sizeof(*drawable_pool) * (drawable_pool_len - best - 1));
+    drawable_pool_len--;
+    return &taken;
+}
+
 drawable_t *
 drawable_allocator(lua_State *L, drawable_refresh_callback *callback, void *data)
 {
@@ -115,6 +209,7 @@ drawable_allocator(lua_State *L, drawable_refresh_callback *callback, void *data
     d->refreshed = false;
     d->surface = NULL;
     d->pixmap = XCB_NONE;
+    d->pixmap_width = d->pixmap_height = 0;
     return d;
 }
 
@@ -124,10 +219,53 @@ drawable_unset_surface(drawable_t *d)
     cairo_surface_finish(d->surface);
     cairo_surface_destroy(d->surface);
     if (d->pixmap)
-        xcb_free_pixmap(globalconf.connection, d->pixmap);
+        drawable_pool_put(d->pixmap, d->pixmap_width, d->pixmap_height);
     d->refreshed = false;
     d->surface = NULL;
     d->pixmap = XCB_NONE;
+    d->pixmap_width = d->pixmap_height = 0;
+}
+
+/** Give a drawable a new surface for its current geometry.
+ * \param d The drawable.
+ * \param grow_width The pixmap width the drawable had before, to grow from.
+ * \param grow_height The pixmap height the drawable had before, to grow from.
+ */
+static void
+drawable_create_surface(drawable_t *d, uint16_t grow_width, uint16_t grow_height)
+{
+    uint16_t width = d->geometry.width, height = d->geometry.height;
+    drawable_pooled_pixmap_t *pooled = drawable_pool_take(width, height);
+
+    if (pooled)
+    {
+        drawable_pool_hits++;
+        d->pixmap = pooled->pixmap;
+        d->pixmap_width = pooled->width;
+        d->pixmap_height = pooled->height;
+    }
+    else
+    {
+        /* Something that grows once will likely grow again (e.g. during an
+         * animation), so leave some room. The first pixmap has no slack. */
+        uint32_t limit_width = MAX(width, globalconf.screen->width_in_pixels);
+        uint32_t limit_height = MAX(height, globalconf.screen->height_in_pixels);
+        if (grow_width && width > grow_width)
+            width = MIN(MAX(width, grow_width * 3 / 2), limit_width);
+        if (grow_height && height > grow_height)
+            height = MIN(MAX(height, grow_height * 3 / 2), limit_height);
+
+        drawable_pool_misses++;
+        d->pixmap = xcb_generate_id(globalconf.connection);
+        d->pixmap_width = width;
+        d->pixmap_height = height;
+        xcb_create_pixmap(globalconf.connection, globalconf.default_depth, d->pixmap,
+                          globalconf.screen->root, width, height);
+    }
+
+    d->surface = cairo_xcb_surface_create(globalconf.connection,
+                                          d->pixmap, globalconf.visual,
+                                          d->geometry.width, d->geometry.height);
 }
 
 static void
@@ -144,18 +282,25 @@ drawable_set_geometry(lua_State *L, int didx, area_t geom)
     d->geometry = geom;
 
     bool size_changed = (old.width != geom.width) || (old.height != geom.height);
-    if (size_changed)
-        drawable_unset_surface(d);
-    if (size_changed && geom.width > 0 && geom.height > 0)
+    bool has_size = geom.width > 0 && geom.height > 0;
+    if (size_changed && has_size && d->surface
+        && drawable_pixmap_fits(d->pixmap_width, d->pixmap_height, geom.width, geom.height))
     {
-        d->pixmap = xcb_generate_id(globalconf.connection);
-        xcb_create_pixmap(globalconf.connection, globalconf.default_depth, d->pixmap,
-                          globalconf.screen->root, geom.width, geom.height);
-        d->surface = cairo_xcb_surface_create(globalconf.connection,
-                                              d->pixmap, globalconf.visual,
-                                              geom.width, geom.height);
-        luaA_object_emit_signal(L, didx, "property::surface", 0);
+        /* The pixmap is large enough, only use a different part of it */
+        drawable_pool_hits++;
+        cairo_surface_flush(d->surface);
+        cairo_xcb_surface_set_size(d->surface, geom.width, geom.height);
+        d->refreshed = false;
     }
+    else if (size_changed)
+    {
+        uint16_t grow_width = d->pixmap_width, grow_height = d->pixmap_height;
+        drawable_unset_surface(d);
+        if (has_size)
+            drawable_create_surface(d, grow_width, grow_height);
+    }
+    if (size_changed && has_size)
+        luaA_object_emit_signal(L, didx, "property::surface", 0);
 
     if (!AREA_EQUAL(old, geom))
         luaA_object_emit_signal(L, didx, "property::geometry", 0);
@@ -188,14 +333,52 @@ luaA_drawable_get_surface(lua_State *L, drawable_t *drawable)
 /** Refresh a drawable's content. This has to be called whenever some drawing to
  * the drawable's surface has been done and should become visible.
  *
+ * @tparam[opt] table rectangles A list of tables with `x`, `y`, `width` and
+ *   `height` describing the parts of the drawable that changed. Everything is
+ *   made visible if this is not given.
  * @function refresh
  */
 static int
 luaA_drawable_refresh(lua_State *L)
 {
     drawable_t *drawable = luaA_checkudata(L, 1, &drawable_class);
+    area_t full = { .x = 0, .y = 0,
+                    .width = drawable->geometry.width,
+                    .height = drawable->geometry.height };
+
+    /* Everything was drawn if the contents were undefined before */
+    bool partial = drawable->refreshed && !lua_isnoneornil(L, 2);
     drawable->refreshed = true;
-    (*drawable->refresh_callback)(drawable->refresh_data);
+
+    if (!partial)
+    {
+        (*drawable->refresh_callback)(drawable->refresh_data, full);
+        return 0;
+    }
+
+    luaA_checktable(L, 2);
+    for (int i = 1; i <= (int) luaA_rawlen(L, 2); i++)
+    {
+        lua_rawgeti(L, 2, i);
+        luaA_checktable(L, -1);
+        int x = luaA_getopt_integer(L, -1, "x", 0);
+        int y = luaA_getopt_integer(L, -1, "y", 0);
+        int width = luaA_getopt_integer(L, -1, "width", 0);
+        int height = luaA_getopt_integer(L, -1, "height", 0);
+        lua_pop(L, 1);
+
+        /* Only copy what is inside of the drawable */
+        int x1 = MAX(x, 0), y1 = MAX(y, 0);
+        int x2 = MIN(x + width, full.width);
+        int y2 = MIN(y + height, full.height);
+        if (x2 <= x1 || y2 <= y1)
+            continue;
+
+        (*drawable->refresh_callback)(drawable->refresh_data,
+                                      (area_t) { .x = x1, .y = y1,
+                                                 .width = x2 - x1,
+                                                 .height = y2 - y1 });
+    }
 
     return 0;
 }
@@ -26,7 +26,8 @@
 #include "common/luaclass.h"
 #include "draw.h"
 
-typedef void drawable_refresh_callback(void *);
+/** Callback making a part of a drawable visible, in drawable coordinates */
+typedef void drawable_refresh_callback(void *, area_t);
 
 /** drawable type */
 struct drawable_t
@@ -34,6 +35,8 @@ struct drawable_t
     LUA_OBJECT_HEADER
     /** The pixmap we are drawing to. */
     xcb_pixmap_t pixmap;
+    /** The size of the pixmap, which can be larger than the geometry. */
+    uint16_t pixmap_width, pixmap_height;
     /** Surface for drawing. */
     cairo_surface_t *surface;
     /** The geometry of the drawable (in root window coordinates). */
@@ -50,6 +53,7 @@ typedef struct drawable_t drawable_t;
 drawable_t *drawable_allocator(lua_State *, drawable_refresh_callback *, void *);
 void drawable_set_geometry(lua_State *, int, area_t);
 void drawable_class_setup(lua_State *);
+void drawable_get_pool_stats(unsigned long *, unsigned long *);
 
 #endif
 // vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -176,6 +176,8 @@ drawin_wipe(drawin_t *w)
     {
         /* Make sure we don't accidentally kill the systray window */
         drawin_systray_kickout(w);
+        window_index_remove(w->window);
+        stack_forget_window(w->window);
         xcb_destroy_window(globalconf.connection, w->window);
         w->window = XCB_NONE;
     }
@@ -194,11 +196,12 @@ drawin_update_drawing(lua_State *L, int widx)
 
 /** Refresh the window content by copying its pixmap data to its window.
  * \param w The drawin to refresh.
+ * \param area The part of the drawin that changed.
  */
 static inline void
-drawin_refresh_pixmap(drawin_t *w)
+drawin_refresh_pixmap(drawin_t *w, area_t area)
 {
-    drawin_refresh_pixmap_partial(w, 0, 0, w->geometry.width, w->geometry.height);
+    drawin_refresh_pixmap_partial(w, area.x, area.y, area.width, area.height);
 }
 
 static void
@@ -253,15 +256,15 @@ drawin_moveresize(lua_State *L, int udx, area_t geometry)
     drawin_update_drawing(L, udx);
 
     if (!AREA_EQUAL(old_geometry, w->geometry))
-        luaA_object_emit_signal(L, udx, "property::geometry", 0);
+        luaA_object_emit_signal_id(L, udx, SIGNAL_ID("property::geometry"), 0);
     if (old_geometry.x != w->geometry.x)
-        luaA_object_emit_signal(L, udx, "property::x", 0);
+        luaA_object_emit_signal_id(L, udx, SIGNAL_ID("property::x"), 0);
     if (old_geometry.y != w->geometry.y)
-        luaA_object_emit_signal(L, udx, "property::y", 0);
+        luaA_object_emit_signal_id(L, udx, SIGNAL_ID("property::y"), 0);
     if (old_geometry.width != w->geometry.width)
-        luaA_object_emit_signal(L, udx, "property::width", 0);
+        luaA_object_emit_signal_id(L, udx, SIGNAL_ID("property::width"), 0);
     if (old_geometry.height != w->geometry.height)
-        luaA_object_emit_signal(L, udx, "property::height", 0);
+        luaA_object_emit_signal_id(L, udx, SIGNAL_ID("property::height"), 0);
 
     screen_t *old_screen = screen_getbycoord(old_geometry.x, old_geometry.y);
     screen_t *new_screen = screen_getbycoord(w->geometry.x, w->geometry.y);
@@ -337,9 +340,10 @@ drawin_unmap(drawin_t *drawin)
 drawin_t *
 drawin_getbywin(xcb_window_t win)
 {
-    foreach(w, globalconf.drawins)
-        if((*w)->window == win)
-            return *w;
+    drawin_t *w = (drawin_t *) window_index_lookup(win, WINDOW_INDEX_DRAWIN);
+    /* Hidden drawins are not part of globalconf.drawins, ignore them */
+    if(w && w->visible)
+        return w;
     return NULL;
 }
 
@@ -425,6 +429,7 @@ drawin_allocator(lua_State *L)
                           globalconf.default_cmap,
                           xcursor_new(globalconf.cursor_ctx, xcursor_font_fromstr(w->cursor))
                       });
+    window_index_add(w->window, WINDOW_INDEX_DRAWIN, (window_t *) w);
     xwindow_set_class_instance(w->window);
     xwindow_set_name_static(w->window, "Awesome drawin");
 
@@ -61,6 +61,65 @@
 
 LUA_CLASS_FUNCS(window, window_class)
 
+/** An entry in the window index */
+typedef struct
+{
+    window_index_kind_t kind;
+    window_t *window;
+} window_index_entry_t;
+
+/** Create the index mapping X window ids to the objects using them. */
+void
+window_index_init(void)
+{
+    globalconf.windows = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                               NULL, free);
+}
+
+/** Remember which object an X window belongs to.
+ * \param win The X window id.
+ * \param kind What the window is used for.
+ * \param window The client or drawin owning the window.
+ */
+void
+window_index_add(xcb_window_t win, window_index_kind_t kind, window_t *window)
+{
+    window_index_entry_t *entry;
+
+    if(win == XCB_NONE)
+        return;
+
+    entry = p_new(window_index_entry_t, 1);
+    entry->kind = kind;
+    entry->window = window;
+    g_hash_table_insert(globalconf.windows, GUINT_TO_POINTER(win), entry);
+}
+
+/** Forget about an X window.
+ * \param win The X window id.
+ */
+void
+window_index_remove(xcb_window_t win)
+{
+    if(win != XCB_NONE)
+        g_hash_table_remove(globalconf.windows, GUINT_TO_POINTER(win));
+}
+
+/** Find the object owning an X window.
+ * \param win The X window id.
+ * \param kind What the window has to be used for.
+ * \return The object if found, NULL otherwise.
+ */
+window_t *
+window_index_lookup(xcb_window_t win, window_index_kind_t kind)
+{
+    window_index_entry_t *entry = g_hash_table_lookup(globalconf.windows,
+                                                      GUINT_TO_POINTER(win));
+    if(entry && entry->kind == kind)
+        return entry->window;
+    return NULL;
+}
+
 static xcb_window_t
 window_get(window_t *window)
 {
@@ -170,6 +229,17 @@ luaA_window_get_opacity(lua_State *L, window_t *window)
     return 1;
 }
 
+/** Remember that the window border has to be sent to X.
+ * \param window The window object.
+ */
+static void
+window_border_need_update(window_t *window)
+{
+    window->border_need_update = true;
+    if(window->border_need_update_callback)
+        (*window->border_need_update_callback)(window);
+}
+
 void
 window_border_refresh(window_t *window)
 {
@@ -197,7 +267,7 @@ luaA_window_set_border_color(lua_State *L, window_t *window)
     if(color_name &&
        color_init_reply(color_init_unchecked(&window->border_color, color_name, len)))
     {
-        window->border_need_update = true;
+        window_border_need_update(window);
         luaA_object_emit_signal(L, -3, "property::border_color", 0);
     }
 
@@ -218,7 +288,7 @@ window_set_border_width(lua_State *L, int idx, int width)
     if(width == window->border_width || width < 0)
         return;
 
-    window->border_need_update = true;
+    window_border_need_update(window);
     window->border_width = width;
 
     if(window->border_width_callback)
@@ -72,7 +72,9 @@ typedef enum
     /** The window type */ \
     window_type_t type; \
     /** The border width callback */ \
-    void (*border_width_callback)(void *, uint16_t old, uint16_t new);
+    void (*border_width_callback)(void *, uint16_t old, uint16_t new); \
+    /** Called when the border has to be refreshed */ \
+    void (*border_need_update_callback)(void *);
 
 /** Window structure */
 typedef struct
@@ -80,6 +82,19 @@ typedef struct
     WINDOW_OBJECT_HEADER
 } window_t;
 
+/** What an X window in the window index belongs to */
+typedef enum
+{
+    /** The client's own window */
+    WINDOW_INDEX_CLIENT,
+    /** The frame window we reparented a client into */
+    WINDOW_INDEX_CLIENT_FRAME,
+    /** The window that gets the input focus for nofocus clients */
+    WINDOW_INDEX_CLIENT_NOFOCUS,
+    /** A drawin's window */
+    WINDOW_INDEX_DRAWIN
+} window_index_kind_t;
+
 lua_class_t window_class;
 
 void window_class_setup(lua_State *);
@@ -93,5 +108,10 @@ uint32_t window_translate_type(window_type_t);
 int window_set_xproperty(lua_State *, xcb_window_t, int, int);
 int window_get_xproperty(lua_State *, xcb_window_t, int);
 
+void window_index_init(void);
+void window_index_add(xcb_window_t, window_index_kind_t, window_t *);
+void window_index_remove(xcb_window_t);
+window_t * window_index_lookup(xcb_window_t, window_index_kind_t);
+
 #endif
 // vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
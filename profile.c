@@ -0,0 +1,217 @@
+/*
+ * profile.c - main loop profiling
+ *
+ * Copyright © 2017 The awesome developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/**
+ * @module awesome
+ */
+
+#include "profile.h"
+#include "globalconf.h"
+#include "common/luaobject.h"
+#include "objects/drawable.h"
+#include "draw.h"
+#include "ewmh.h"
+
+#include <glib.h>
+#include <math.h>
+
+/** Number of histogram buckets. Bucket i counts durations below 2^i
+ * microseconds, the last one counts everything longer. */
+#define PROFILE_BUCKETS 24
+
+typedef struct
+{
+    /** Number of times the phase ran */
+    uint64_t count;
+    /** Total time spent, in microseconds */
+    uint64_t total;
+    /** Longest run, in microseconds */
+    uint64_t max;
+    /** Log2-bucketed histogram of the durations */
+    uint64_t buckets[PROFILE_BUCKETS];
+} profile_stats_t;
+
+static profile_stats_t profile_stats[PROFILE_PHASE_COUNT];
+
+/** How many Lua callbacks are running, only the outermost one is timed */
+static int profile_callback_depth;
+
+static const char *const profile_phase_names[PROFILE_PHASE_COUNT] =
+{
+    [PROFILE_X_EVENTS] = "x_events",
+    [PROFILE_GLIB_DISPATCH] = "glib_dispatch",
+    [PROFILE_SCREEN_REFRESH] = "screen_refresh",
+    [PROFILE_LUA_REFRESH] = "lua_refresh",
+    [PROFILE_DRAWIN_REFRESH] = "drawin_refresh",
+    [PROFILE_CLIENT_REFRESH] = "client_refresh",
+    [PROFILE_BANNING_REFRESH] = "banning_refresh",
+    [PROFILE_STACK_REFRESH] = "stack_refresh",
+    [PROFILE_DESTROY_LATER] = "destroy_later",
+    [PROFILE_LUA_CALLBACKS] = "lua_callbacks",
+    [PROFILE_ITERATION] = "iteration",
+};
+
+/** Get the current time for profiling.
+ * \return The current monotonic time in microseconds.
+ */
+int64_t
+profile_now(void)
+{
+    return g_get_monotonic_time();
+}
+
+/** Record that a phase finished.
+ * \param phase The phase that finished.
+ * \param start The time the phase started, as returned by profile_now().
+ * \return The current time, so that the next phase can start from it.
+ */
+int64_t
+profile_phase_done(profile_phase_t phase, int64_t start)
+{
+    int64_t now = profile_now();
+    uint64_t duration = MAX(now - start, 0);
+    profile_stats_t *stats = &profile_stats[phase];
+    int bucket = 0;
+
+    while(bucket < PROFILE_BUCKETS - 1 && duration >= (UINT64_C(1) << bucket))
+        bucket++;
+
+    stats->count++;
+    stats->total += duration;
+    stats->max = MAX(stats->max, duration);
+    stats->buckets[bucket]++;
+
+    return now;
+}
+
+/** Record that a Lua callback starts.
+ * \return The start time to pass to profile_callback_done(), or 0 if the
+ * callback was called from another callback.
+ */
+int64_t
+profile_callback_start(void)
+{
+    return profile_callback_depth++ == 0 ? profile_now() : 0;
+}
+
+/** Record that a Lua callback finished.
+ * \param start The value returned by profile_callback_start().
+ */
+void
+profile_callback_done(int64_t start)
+{
+    profile_callback_depth--;
+    if(start)
+        profile_phase_done(PROFILE_LUA_CALLBACKS, start);
+}
+
+/** Get statistics about where the main loop spends its time.
+ *
+ * The returned table contains one entry for each phase of a main loop
+ * iteration: `x_events`, `glib_dispatch` (timers, spawn callbacks and D-Bus),
+ * `screen_refresh`, `lua_refresh` (the `refresh` signal), `drawin_refresh`,
+ * `client_refresh`, `banning_refresh`, `stack_refresh`, `destroy_later` and
+ * `iteration` (a whole iteration without the time spent sleeping). The
+ * additional entry `lua_callbacks` is the time spent in Lua functions called
+ * from C, like signal handlers, timers and spawn callbacks. It overlaps with
+ * the phases in which the callbacks ran; callbacks called from other
+ * callbacks are only counted once. Each
+ * entry is a table with the fields `count`, `total` and `max` (in seconds)
+ * and `histogram`. The histogram is a list of `{ limit = seconds, count = n }`
+ * tables, each counting the runs that took less than its limit, but not
+ * less than the limit of the previous one. The last limit is `math.huge`.
+ *
+ * Additionally, the fields `skipped_signal_emits` and `folded_events` contain
+ * the values of the fields of the same name of `awesome`.
+ * `pixmap_pool_hits` and `pixmap_pool_misses` count how often a drawable
+ * changing its size could reuse a pixmap or had to create a new one.
+ * `icon_cache_hits` and `icon_cache_misses` count how often a client's
+ * `_NET_WM_ICON` was already decoded or had to be decoded.
+ * `async_image_decodes` counts the images that `awesome.load_image_async`
+ * decoded. Loads that shared the result of another load are not counted.
+ *
+ * @tparam[opt=false] boolean reset Reset all statistics after returning them.
+ * @treturn table The statistics.
+ * @function stats
+ */
+int
+luaA_profile_stats(lua_State *L)
+{
+    bool reset = lua_toboolean(L, 1);
+
+    unsigned long pool_hits, pool_misses, icon_hits, icon_misses;
+
+    lua_createtable(L, 0, PROFILE_PHASE_COUNT + 7);
+
+    for(int i = 0; i < PROFILE_PHASE_COUNT; i++)
+    {
+        profile_stats_t *stats = &profile_stats[i];
+
+        lua_createtable(L, 0, 4);
+        lua_pushnumber(L, stats->count);
+        lua_setfield(L, -2, "count");
+        lua_pushnumber(L, stats->total / 1e6);
+        lua_setfield(L, -2, "total");
+        lua_pushnumber(L, stats->max / 1e6);
+        lua_setfield(L, -2, "max");
+
+        lua_createtable(L, PROFILE_BUCKETS, 0);
+        for(int j = 0; j < PROFILE_BUCKETS; j++)
+        {
+            lua_createtable(L, 0, 2);
+            if(j == PROFILE_BUCKETS - 1)
+                lua_pushnumber(L, HUGE_VAL);
+            else
+                lua_pushnumber(L, (UINT64_C(1) << j) / 1e6);
+            lua_setfield(L, -2, "limit");
+            lua_pushnumber(L, stats->buckets[j]);
+            lua_setfield(L, -2, "count");
+            lua_rawseti(L, -2, j + 1);
+        }
+        lua_setfield(L, -2, "histogram");
+
+        lua_setfield(L, -2, profile_phase_names[i]);
+    }
+
+    lua_pushnumber(L, signal_get_skipped_emits());
+    lua_setfield(L, -2, "skipped_signal_emits");
+    lua_pushnumber(L, globalconf.folded_events);
+    lua_setfield(L, -2, "folded_events");
+    drawable_get_pool_stats(&pool_hits, &pool_misses);
+    lua_pushnumber(L, pool_hits);
+    lua_setfield(L, -2, "pixmap_pool_hits");
+    lua_pushnumber(L, pool_misses);
+    lua_setfield(L, -2, "pixmap_pool_misses");
+    ewmh_get_icon_cache_stats(&icon_hits, &icon_misses);
+    lua_pushnumber(L, icon_hits);
+    lua_setfield(L, -2, "icon_cache_hits");
+    lua_pushnumber(L, icon_misses);
+    lua_setfield(L, -2, "icon_cache_misses");
+    lua_pushnumber(L, draw_get_image_decodes());
+    lua_setfield(L, -2, "async_image_decodes");
+
+    if(reset)
+        p_clear(profile_stats, PROFILE_PHASE_COUNT);
+
+    return 1;
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
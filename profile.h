@@ -0,0 +1,59 @@
+/*
+ * profile.h - main loop profiling header
+ *
+ * Copyright © 2017 The awesome developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AWESOME_PROFILE_H
+#define AWESOME_PROFILE_H
+
+#include <stdint.h>
+#include <lua.h>
+
+/** The phases of a main loop iteration which are timed */
+typedef enum
+{
+    /** Reading and handling X events */
+    PROFILE_X_EVENTS,
+    /** GLib sources like timers, spawn callbacks and D-Bus */
+    PROFILE_GLIB_DISPATCH,
+    /** The parts of awesome_refresh() */
+    PROFILE_SCREEN_REFRESH,
+    PROFILE_LUA_REFRESH,
+    PROFILE_DRAWIN_REFRESH,
+    PROFILE_CLIENT_REFRESH,
+    PROFILE_BANNING_REFRESH,
+    PROFILE_STACK_REFRESH,
+    PROFILE_DESTROY_LATER,
+    /** Lua callbacks like signal handlers, overlapping the other phases */
+    PROFILE_LUA_CALLBACKS,
+    /** A whole main loop iteration, without the time spent sleeping */
+    PROFILE_ITERATION,
+    PROFILE_PHASE_COUNT
+} profile_phase_t;
+
+int64_t profile_now(void);
+int64_t profile_phase_done(profile_phase_t, int64_t);
+int64_t profile_callback_start(void);
+void profile_callback_done(int64_t);
+
+int luaA_profile_stats(lua_State *);
+
+#endif
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -29,6 +29,68 @@
 
 #include <xcb/xcb_atom.h>
 
+/** A property update whose reply was not read yet */
+typedef struct
+{
+    /** The client window the property belongs to */
+    xcb_window_t window;
+    /** The function to call with the reply */
+    void (*update)(client_t *, xcb_get_property_cookie_t);
+    /** The cookie of the GetProperty request */
+    xcb_get_property_cookie_t cookie;
+} property_pending_t;
+
+DO_ARRAY(property_pending_t, property_pending, DO_NOTHING)
+
+/** Property updates waiting for property_handle_pending() */
+static property_pending_array_t property_pending;
+
+/** Queue a property update, its reply is read in property_handle_pending().
+ * \param window The client window.
+ * \param update The function to call with the reply.
+ * \param cookie The cookie of the request that was sent.
+ */
+static void
+property_pending_add(xcb_window_t window,
+                     void (*update)(client_t *, xcb_get_property_cookie_t),
+                     xcb_get_property_cookie_t cookie)
+{
+    property_pending_array_append(&property_pending, (property_pending_t)
+                                  {
+                                      .window = window,
+                                      .update = update,
+                                      .cookie = cookie
+                                  });
+}
+
+/** Read the replies of all queued property updates and apply them.
+ * All requests were already sent, so this only waits for one round-trip to
+ * the X server, no matter how many properties changed.
+ */
+void
+property_handle_pending(void)
+{
+    if(property_pending.len == 0)
+        return;
+
+    /* Updates run Lua code which might end up here again, so take the queue
+     * before handling it */
+    property_pending_array_t pending = property_pending;
+    property_pending_array_init(&property_pending);
+
+    foreach(p, pending)
+    {
+        client_t *c = client_getbywin(p->window);
+
+        if(c)
+            p->update(c, p->cookie);
+        else
+            xcb_discard_reply(globalconf.connection, p->cookie.sequence);
+    }
+
+    property_pending_array_wipe(&pending);
+}
+
 #define HANDLE_TEXT_PROPERTY(funcname, atom, setfunc) \
     xcb_get_property_cookie_t \
     property_get_##funcname(client_t *c) \
@@ -58,7 +120,8 @@
     { \
         client_t *c = client_getbywin(window); \
         if(c) \
-            property_update_##funcname(c, property_get_##funcname(c));\
+            property_pending_add(window, property_update_##funcname, \
+                                 property_get_##funcname(c)); \
         return 0; \
     }
 
@@ -79,7 +142,8 @@ HANDLE_TEXT_PROPERTY(wm_window_role, WM_WINDOW_ROLE, client_set_role)
     { \
         client_t *c = client_getbywin(window); \
         if(c) \
-            property_update_##name(c, property_get_##name(c));\
+            property_pending_add(window, property_update_##name, \
+                                 property_get_##name(c)); \
         return 0; \
     }
 
@@ -262,13 +326,15 @@ property_get_net_wm_icon(client_t *c)
 void
 property_update_net_wm_icon(client_t *c, xcb_get_property_cookie_t cookie)
 {
-    cairo_surface_t *surface = ewmh_window_icon_get_reply(cookie, globalconf.preferred_icon_size);
+    cairo_surface_t *surface = ewmh_window_icon_get_reply(c->window, cookie, globalconf.preferred_icon_size);
 
     if(!surface)
         return;
 
     c->have_ewmh_icon = true;
-    client_set_icon(c, surface);
+    /* Icons come from a cache, so an unchanged icon is the same surface */
+    if(surface != c->icon)
+        client_set_icon_shared(c, surface);
     cairo_surface_destroy(surface);
 }
 
@@ -46,6 +46,7 @@ PROPERTY(net_wm_icon);
 #undef PROPERTY
 
 void property_handle_propertynotify(xcb_property_notify_event_t *ev);
+void property_handle_pending(void);
 int luaA_register_xproperty(lua_State *L);
 int luaA_set_xproperty(lua_State *L);
 int luaA_get_xproperty(lua_State *L);
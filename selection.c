@@ -30,6 +30,7 @@
 #include "globalconf.h"
 #include "common/atoms.h"
 #include "event.h"
+#include "property.h"
 #include "xwindow.h"
 
 #include <xcb/xcb_atom.h>
@@ -92,6 +93,7 @@ luaA_selection_get(lua_State *L)
              */
             event_handle(event);
             p_delete(&event);
+            property_handle_pending();
             awesome_refresh();
             continue;
         }
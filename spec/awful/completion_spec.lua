@@ -0,0 +1,62 @@
+---------------------------------------------------------------------------
+-- @author The awesome developers
+-- @copyright 2017 The awesome developers
+---------------------------------------------------------------------------
+
+local completion = require("awful.completion")
+
+describe("awful.completion.index", function()
+    local firefox = { name = "Firefox", cmdline = "firefox %u" }
+    local gimp = { name = "GNU Image Manipulation Program", cmdline = "gimp-2.8" }
+    local xterm = { name = "XTerm", cmdline = "xterm", keywords = "shell;prompt;" }
+    local items = { firefox, gimp, xterm }
+
+    local index
+    before_each(function()
+        index = completion.index(items, function(item)
+            return { item.name, item.cmdline, item.keywords }
+        end)
+    end)
+
+    it("empty query", function()
+        local matches, ranks = index:search("")
+        assert.is.same(items, matches)
+        assert.is.equal(2, ranks[gimp])
+    end)
+
+    it("prefix", function()
+        local matches, ranks = index:search("GIM")
+        assert.is.same({ gimp }, matches)
+        assert.is.equal(2, ranks[gimp])
+    end)
+
+    it("substring", function()
+        local matches, ranks = index:search("fox")
+        assert.is.same({ firefox }, matches)
+        assert.is.equal(1, ranks[firefox])
+
+        matches, ranks = index:search("prompt")
+        assert.is.same({ xterm }, matches)
+        assert.is.equal(1, ranks[xterm])
+    end)
+
+    it("fuzzy", function()
+        local matches, ranks = index:search("gimpr")
+        assert.is.same({ gimp }, matches)
+        assert.is.equal(0, ranks[gimp])
+
+        -- Only the first string is searched fuzzily
+        assert.is.same({}, index:search("xtsh"))
+        assert.is.same({}, index:search("zzz"))
+    end)
+
+    it("refine and go back", function()
+        assert.is.same({ firefox, xterm }, index:search("x"))
+        assert.is.same({ xterm }, index:search("xt"))
+        assert.is.same({ firefox, xterm }, index:search("x"))
+        assert.is.same({ gimp, xterm }, index:search("p"))
+        assert.is.same({ gimp }, index:search("pg"))
+    end)
+end)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -126,6 +126,10 @@ describe("gears.matrix", function()
             test(matrix.create_rotate(math.pi / 2),
                 1, 2, 3, 4, -6, 1, 4, 3)
         end)
+
+        it("Translate", function()
+            test(matrix.create_translate(2, 3), 1, 2, 3, 4, 3, 5, 3, 4)
+        end)
     end)
 
     it("tostring", function()
@@ -151,6 +155,46 @@ describe("gears.matrix", function()
         assert.is.equal(0, m.y0)
     end)
 
+    describe("in place", function()
+        it("set", function()
+            local m = matrix.acquire(1, 0, 0, 1, 0, 0)
+            assert.is.equal(m, m:set(1, 2, 3, 4, 5, 6))
+            assert.is.equal(matrix.create(1, 2, 3, 4, 5, 6), m)
+        end)
+
+        it("multiply_into", function()
+            local a = matrix.create(1, 2, 3, 4, 5, 6)
+            local b = matrix.create(7, 8, 9, 1, 1, 1)
+            local m = matrix.acquire(1, 0, 0, 1, 0, 0)
+            assert.is.equal(a * b, matrix.multiply_into(m, a, b))
+            assert.is.equal(a * b, matrix.acquire(1, 2, 3, 4, 5, 6):multiply_in_place(b))
+        end)
+
+        it("translate, scale and rotate", function()
+            local m = matrix.acquire(1, 2, 3, 4, 5, 6)
+            m:translate_in_place(2, 3):scale_in_place(4, 5):rotate_in_place(1)
+            local expected = matrix.create(1, 2, 3, 4, 5, 6):translate(2, 3):scale(4, 5):rotate(1)
+            for _, k in ipairs{ "xx", "xy", "yx", "yy", "x0", "y0" } do
+                assert.is_true(math.abs(m[k] - expected[k]) < 0.00000001)
+            end
+        end)
+
+        it("cannot modify identity", function()
+            assert.has.errors(function()
+                matrix.identity:set(1, 2, 3, 4, 5, 6)
+            end)
+        end)
+
+        it("reuses released matrices", function()
+            local m = matrix.acquire(1, 2, 3, 4, 5, 6)
+            m:release()
+            local allocations = matrix.get_allocations()
+            assert.is_true(rawequal(m, matrix.acquire(6, 5, 4, 3, 2, 1)))
+            assert.is.equal(allocations, matrix.get_allocations())
+            assert.is.equal(matrix.create(6, 5, 4, 3, 2, 1), m)
+        end)
+    end)
+
     describe("rotate_at", function()
         it("create", function()
             local m = matrix.create_rotate_at(5, 5, math.pi)
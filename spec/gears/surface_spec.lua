@@ -0,0 +1,33 @@
+---------------------------------------------------------------------------
+-- @author The awesome developers
+-- @copyright 2017 The awesome developers
+---------------------------------------------------------------------------
+
+local surface = require("gears.surface")
+local cairo = require("lgi").cairo
+
+describe("gears.surface", function()
+    describe("scaled", function()
+        local source = cairo.ImageSurface(cairo.Format.ARGB32, 20, 10)
+
+        it("has the requested size", function()
+            local result = surface.scaled(source, 10, 5)
+            assert.is.equal(10, result:get_width())
+            assert.is.equal(5, result:get_height())
+        end)
+
+        it("is cached", function()
+            local result = surface.scaled(source, 8, 4)
+            assert.is.equal(result, surface.scaled(source, 8, 4))
+            assert.is_not.equal(result, surface.scaled(source, 4, 2))
+        end)
+
+        it("can be invalidated", function()
+            local result = surface.scaled(source, 6, 3)
+            surface.invalidate_scaled(source)
+            assert.is_not.equal(result, surface.scaled(source, 6, 3))
+        end)
+    end)
+end)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
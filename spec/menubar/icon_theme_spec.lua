@@ -7,6 +7,8 @@ local os = os
 local string = string
 local icon_theme = require("menubar.icon_theme")
 
+icon_theme.cache_file = os.tmpname()
+
 local base_directories = {
     (os.getenv("SOURCE_DIRECTORY") or '.') .. "/spec/menubar/icons",
     (os.getenv("SOURCE_DIRECTORY") or '.') .. "/icons"
@@ -60,4 +62,57 @@ describe("menubar.icon_theme find_icon_path", function()
     end
 end)
 
+describe("menubar.icon_theme cache", function()
+    it("is saved and reused", function()
+        local obj = icon_theme("awesome", base_directories)
+        local expected = obj:find_icon_path("awesome", 32)
+
+        local f = io.open(icon_theme.cache_file)
+        local content = f:read("*a")
+        f:close()
+        assert.is_not_nil(content:find(base_directories[1] .. "/awesome/32x32/apps", 1, true))
+        assert.is_not_nil(content:find("awesome.png", 1, true))
+
+        -- Load a fresh instance of the module which counts the directories
+        -- that it lists
+        local lgi = require("lgi")
+        local listed = 0
+        local function fresh_module()
+            local File = setmetatable({
+                new_for_path = function(path)
+                    local file = lgi.Gio.File.new_for_path(path)
+                    return setmetatable({
+                        enumerate_children = function(_, ...)
+                            listed = listed + 1
+                            return file:enumerate_children(...)
+                        end
+                    }, { __index = function(_, k)
+                        return function(_, ...) return file[k](file, ...) end
+                    end })
+                end
+            }, { __index = lgi.Gio.File })
+            package.loaded.lgi = setmetatable({ Gio = setmetatable({ File = File }, { __index = lgi.Gio }) },
+                                              { __index = lgi })
+            package.loaded["menubar.icon_theme"] = nil
+            local fresh = require("menubar.icon_theme")
+            fresh.cache_file = icon_theme.cache_file
+            package.loaded.lgi = lgi
+            package.loaded["menubar.icon_theme"] = icon_theme
+            return fresh
+        end
+
+        -- With the cache file, no directory has to be listed
+        local fresh = fresh_module()
+        assert.is.same(expected, fresh("awesome", base_directories):find_icon_path("awesome", 32))
+        assert.is.equal(0, listed)
+
+        -- Without it, they are listed again
+        os.remove(icon_theme.cache_file)
+        fresh = fresh_module()
+        assert.is.same(expected, fresh("awesome", base_directories):find_icon_path("awesome", 32))
+        assert.is_true(listed > 0)
+        os.remove(icon_theme.cache_file)
+    end)
+end)
+
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -258,6 +258,40 @@ describe("wibox.hierarchy", function()
             -- Intermediate drew to 4, 0, 5, 2 (and so does new_intermediate)
             assert.is.same({ rect.x, rect.y, rect.width, rect.height }, { 4, 0, 5, 2 })
         end)
+
+        it("children reordered", function()
+            local child2 = make_widget(nil)
+            intermediate.layout = function()
+                return {
+                    make_child(child, 10, 20, matrix.create_translate(0, 5)),
+                    make_child(child2, 10, 20, matrix.create_translate(10, 5)),
+                }
+            end
+            intermediate:emit_signal("widget::layout_changed")
+            instance:update(context, parent, 15, 16)
+            local children = instance:get_children()[1]:get_children()
+            local hierarchy_child, hierarchy_child2 = children[1], children[2]
+
+            -- Swap the children, their hierarchies are kept
+            intermediate.layout = function()
+                return {
+                    make_child(child2, 10, 20, matrix.create_translate(0, 5)),
+                    make_child(child, 10, 20, matrix.create_translate(10, 5)),
+                }
+            end
+            intermediate:emit_signal("widget::layout_changed")
+            local region = instance:update(context, parent, 15, 16)
+            children = instance:get_children()[1]:get_children()
+            assert.is.equal(children[1], hierarchy_child2)
+            assert.is.equal(children[2], hierarchy_child)
+            assert.is.equal(children[1]:get_widget(), child2)
+            assert.is.equal(children[2]:get_widget(), child)
+
+            -- Both children moved, so everything they cover is redrawn
+            assert.is.equal(region:num_rectangles(), 1)
+            local rect = region:get_rectangle(0)
+            assert.is.same({ rect.x, rect.y, rect.width, rect.height }, { 4, 5, 20, 20 })
+        end)
     end)
 end)
 
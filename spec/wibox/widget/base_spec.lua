@@ -87,6 +87,30 @@ describe("wibox.widget.base", function()
             assert.is_true(called2)
         end)
     end)
+
+    describe("place_widget_at_cached", function()
+        it("reuses unchanged placements", function()
+            local cache = {}
+            local p1 = base.place_widget_at_cached(cache, 1, widget1, 2, 3, 4, 5)
+            assert.is_same({ p1._widget, p1._width, p1._height }, { widget1, 4, 5 })
+            assert.is_same({ p1._matrix:transform_point(0, 0) }, { 2, 3 })
+
+            assert.equals(p1, base.place_widget_at_cached(cache, 1, widget1, 2, 3, 4, 5))
+        end)
+
+        it("replaces changed placements", function()
+            local cache = {}
+            local p1 = base.place_widget_at_cached(cache, 1, widget1, 2, 3, 4, 5)
+            local p2 = base.place_widget_at_cached(cache, 1, widget1, 3, 3, 4, 5)
+            assert.not_equals(p1, p2)
+            assert.is_same({ p2._matrix:transform_point(0, 0) }, { 3, 3 })
+            assert.equals(p2, cache[1])
+
+            local p3 = base.place_widget_at_cached(cache, 1, widget2, 3, 3, 4, 5)
+            assert.not_equals(p2, p3)
+            assert.equals(widget2, p3._widget)
+        end)
+    end)
 end)
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -63,12 +63,30 @@ stack_client_append(client_t *c)
 
 static bool need_stack_refresh = false;
 
+/** The order (bottom to top) of the windows the next stack_refresh() wants */
+static window_array_t stack_order;
+/** Position (plus one) of each window in the order last sent to X */
+static GHashTable *stack_positions;
+/** Clients from globalconf.stack which are transient for another client */
+static client_array_t stack_transients;
+
 void
 stack_windows(void)
 {
     need_stack_refresh = true;
 }
 
+/** Forget about the stacking position of a window which is being destroyed,
+ * so that a new window re-using its id is not assumed to already be in place.
+ * \param w The window.
+ */
+void
+stack_forget_window(xcb_window_t w)
+{
+    if(stack_positions)
+        g_hash_table_remove(stack_positions, GUINT_TO_POINTER(w));
+}
+
 /** Stack a window above another window, without causing errors.
  * \param w The window.
  * \param previous The window which should be below this window.
@@ -87,24 +105,18 @@ stack_window_above(xcb_window_t w, xcb_window_t previous)
                          (uint32_t[]) { previous, XCB_STACK_MODE_ABOVE });
 }
 
-/** Stack a client above.
+/** Put a client and its transient windows on top of the wanted order.
  * \param c The client.
- * \param previous The previous client on the stack.
- * \return The next-previous!
  */
-static xcb_window_t
-stack_client_above(client_t *c, xcb_window_t previous)
+static void
+stack_client_above(client_t *c)
 {
-    stack_window_above(c->frame_window, previous);
-
-    previous = c->frame_window;
+    window_array_append(&stack_order, c->frame_window);
 
     /* stack transient window on top of their parents */
-    foreach(node, globalconf.stack)
+    foreach(node, stack_transients)
         if((*node)->transient_for == c)
-            previous = stack_client_above(*node, previous);
-
-    return previous;
+            stack_client_above(*node);
 }
 
 /** Stacking layout layers */
@@ -155,9 +167,92 @@ client_layer_translator(client_t *c)
     return WINDOW_LAYER_NORMAL;
 }
 
+/** Only keep the topmost occurrence of each window in the wanted order.
+ * Transient windows with their own layer are added twice, and the later
+ * ConfigureWindow request is the one which wins.
+ */
+static void
+stack_order_uniq(void)
+{
+    static GHashTable *seen;
+    int n = stack_order.len;
+
+    if(!seen)
+        seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for(int i = stack_order.len - 1; i >= 0; i--)
+    {
+        gpointer key = GUINT_TO_POINTER(stack_order.tab[i]);
+        if(g_hash_table_contains(seen, key))
+            continue;
+        g_hash_table_add(seen, key);
+        stack_order.tab[--n] = stack_order.tab[i];
+    }
+
+    memmove(stack_order.tab, stack_order.tab + n,
+            (stack_order.len - n) * sizeof(*stack_order.tab));
+    stack_order.len -= n;
+    g_hash_table_remove_all(seen);
+}
+
+/** Send the requests needed to turn the last order sent to X into the wanted
+ * order. Windows which form the longest run that is already correctly ordered
+ * are left alone, everything else is stacked above its new lower neighbour.
+ */
+static void
+stack_order_apply(void)
+{
+    int len = stack_order.len;
+
+    if(len == 0)
+        return;
+
+    int *pos = p_alloca(int, len);
+    int *prev = p_alloca(int, len);
+    int *tails = p_alloca(int, len);
+    bool *keep = p_alloca(bool, len);
+    int ntails = 0;
+
+    for(int i = 0; i < len; i++)
+        pos[i] = GPOINTER_TO_INT(g_hash_table_lookup(stack_positions,
+                                 GUINT_TO_POINTER(stack_order.tab[i])));
+
+    /* The bottom window is never restacked, everything else is stacked
+     * relative to it. If we don't know where it is, restack everything. */
+    keep[0] = true;
+    if(pos[0] > 0)
+        for(int i = 1; i < len; i++)
+        {
+            if(pos[i] <= pos[0])
+                continue;
+
+            /* Longest increasing subsequence of the old positions */
+            int l = 0, r = ntails;
+            while(l < r)
+            {
+                int m = (l + r) / 2;
+                if(pos[tails[m]] < pos[i])
+                    l = m + 1;
+                else
+                    r = m;
+            }
+            prev[i] = l > 0 ? tails[l - 1] : -1;
+            tails[l] = i;
+            if(l == ntails)
+                ntails++;
+        }
+
+    for(int i = ntails > 0 ? tails[ntails - 1] : -1; i >= 0; i = prev[i])
+        keep[i] = true;
+
+    for(int i = 1; i < len; i++)
+        if(!keep[i])
+            stack_window_above(stack_order.tab[i], stack_order.tab[i - 1]);
+}
+
 /** Restack clients.
- * \todo It might be worth stopping to restack everyone and only stack `c'
- * relatively to the first matching in the list.
+ * Only the windows whose position relative to the others changed since the
+ * last call are restacked.
  */
 void
 stack_refresh()
@@ -165,35 +260,53 @@ stack_refresh()
     if(!need_stack_refresh)
         return;
 
-    xcb_window_t next = XCB_NONE;
+    int len = globalconf.stack.len;
+    window_layer_t *layers = p_alloca(window_layer_t, len);
+
+    if(!stack_positions)
+        stack_positions = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    stack_order.len = 0;
+    stack_transients.len = 0;
+    for(int i = 0; i < len; i++)
+    {
+        client_t *c = globalconf.stack.tab[i];
+        layers[i] = client_layer_translator(c);
+        if(c->transient_for)
+            client_array_append(&stack_transients, c);
+    }
 
     /* stack desktop windows */
     for(window_layer_t layer = WINDOW_LAYER_DESKTOP; layer < WINDOW_LAYER_BELOW; layer++)
-        foreach(node, globalconf.stack)
-            if(client_layer_translator(*node) == layer)
-                next = stack_client_above(*node, next);
+        for(int i = 0; i < len; i++)
+            if(layers[i] == layer)
+                stack_client_above(globalconf.stack.tab[i]);
 
     /* first stack not ontop drawin window */
     foreach(drawin, globalconf.drawins)
         if(!(*drawin)->ontop)
-        {
-            stack_window_above((*drawin)->window, next);
-            next = (*drawin)->window;
-        }
+            window_array_append(&stack_order, (*drawin)->window);
 
     /* then stack clients */
     for(window_layer_t layer = WINDOW_LAYER_BELOW; layer < WINDOW_LAYER_COUNT; layer++)
-        foreach(node, globalconf.stack)
-            if(client_layer_translator(*node) == layer)
-                next = stack_client_above(*node, next);
+        for(int i = 0; i < len; i++)
+            if(layers[i] == layer)
+                stack_client_above(globalconf.stack.tab[i]);
 
     /* then stack ontop drawin window */
     foreach(drawin, globalconf.drawins)
         if((*drawin)->ontop)
-        {
-            stack_window_above((*drawin)->window, next);
-            next = (*drawin)->window;
-        }
+            window_array_append(&stack_order, (*drawin)->window);
+
+    stack_order_uniq();
+    stack_order_apply();
+
+    /* Remember what we told the X server */
+    g_hash_table_remove_all(stack_positions);
+    for(int i = 0; i < stack_order.len; i++)
+        g_hash_table_insert(stack_positions,
+                            GUINT_TO_POINTER(stack_order.tab[i]),
+                            GINT_TO_POINTER(i + 1));
 
     need_stack_refresh = false;
 }
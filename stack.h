@@ -22,12 +22,15 @@
 #ifndef AWESOME_STACK_H
 #define AWESOME_STACK_H
 
+#include <xcb/xcb.h>
+
 typedef struct client_t client_t;
 
 void stack_client_remove(client_t *);
 void stack_client_push(client_t *);
 void stack_client_append(client_t *);
 void stack_windows(void);
+void stack_forget_window(xcb_window_t);
 void stack_refresh(void);
 
 #endif
@@ -0,0 +1,171 @@
+/*
+ * bench-premultiply.c - check and benchmark premultiply_argb()
+ *
+ * Copyright © 2017 The awesome developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Compares premultiply_argb() with the double precision loop that
+ * draw_surface_from_data() used before. That loop truncated, while
+ * premultiply_argb() rounds like pixman does, so the results are checked
+ * against the same double precision computation with rounding, and may
+ * differ from the truncating loop by at most one per channel.
+ */
+
+#include "common/premultiply.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** The width and height of the test icons */
+#define ICON_SIZE 256
+/** How many times each conversion is timed */
+#define ITERATIONS 200
+
+/** The loop that draw_surface_from_data() used before premultiply_argb() */
+static void
+premultiply_double(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t a = (src[i] >> 24) & 0xff;
+        double alpha = a / 255.0;
+        uint8_t r = ((src[i] >> 16) & 0xff) * alpha;
+        uint8_t g = ((src[i] >>  8) & 0xff) * alpha;
+        uint8_t b = ((src[i] >>  0) & 0xff) * alpha;
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+/** The same computation, but rounding to the nearest integer */
+static void
+premultiply_double_rounded(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t a = (src[i] >> 24) & 0xff;
+        double alpha = a / 255.0;
+        uint8_t r = lround(((src[i] >> 16) & 0xff) * alpha);
+        uint8_t g = lround(((src[i] >>  8) & 0xff) * alpha);
+        uint8_t b = lround(((src[i] >>  0) & 0xff) * alpha);
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Time a conversion of the given pixels.
+ * \return The mean time per conversion, in microseconds.
+ */
+static double
+measure(void (*f)(uint32_t *, const uint32_t *, size_t),
+        uint32_t *dst, const uint32_t *src, size_t len)
+{
+    double start = now();
+    for(int i = 0; i < ITERATIONS; i++)
+        f(dst, src, len);
+    return (now() - start) / ITERATIONS * 1e6;
+}
+
+/** Compare two conversions of the same pixels.
+ * \return The largest difference of a channel.
+ */
+static int
+max_difference(const uint32_t *a, const uint32_t *b, size_t len)
+{
+    int result = 0;
+    for(size_t i = 0; i < len; i++)
+        for(int shift = 0; shift < 32; shift += 8)
+        {
+            int diff = abs((int) ((a[i] >> shift) & 0xff) - (int) ((b[i] >> shift) & 0xff));
+            if(diff > result)
+                result = diff;
+        }
+    return result;
+}
+
+int
+main(void)
+{
+    size_t len = ICON_SIZE * ICON_SIZE;
+    uint32_t *src = malloc(len * sizeof(*src));
+    uint32_t *reference = malloc(len * sizeof(*src));
+    uint32_t *old = malloc(len * sizeof(*src));
+    uint32_t *result = malloc(len * sizeof(*src));
+    int failed = 0;
+
+    /* Every combination of alpha and channel value, with the three color
+     * channels differing from each other */
+    for(size_t i = 0; i < len; i++)
+    {
+        uint32_t a = i >> 8, c = i & 0xff;
+        src[i] = (a << 24) | (c << 16) | ((c ^ 0x5a) << 8) | (255 - c);
+    }
+
+    premultiply_double_rounded(reference, src, len);
+    premultiply_double(old, src, len);
+
+    /* Also check lengths which are not a multiple of the vector width */
+    for(size_t tail = 0; tail < 4; tail++)
+    {
+        premultiply_argb(result, src, len - tail);
+        if(max_difference(result, reference, len - tail) != 0)
+        {
+            fprintf(stderr, "premultiply_argb() differs from the reference for %zu pixels\n",
+                    len - tail);
+            failed = 1;
+        }
+    }
+
+    /* In place, as draw_surface_from_pixbuf() does it */
+    for(size_t i = 0; i < len; i++)
+        result[i] = src[i];
+    premultiply_argb(result, result, len);
+    if(max_difference(result, reference, len) != 0)
+    {
+        fprintf(stderr, "premultiply_argb() in place differs from the reference\n");
+        failed = 1;
+    }
+
+    if(max_difference(old, reference, len) > 1)
+    {
+        fprintf(stderr, "the old loop differs from the reference by more than one\n");
+        failed = 1;
+    }
+
+    printf("%dx%d icon, mean of %d runs:\n", ICON_SIZE, ICON_SIZE, ITERATIONS);
+    printf("%24s: %8.1f us\n", "old double loop", measure(premultiply_double, old, src, len));
+    printf("%24s: %8.1f us\n", "rounded double loop", measure(premultiply_double_rounded, old, src, len));
+    printf("%24s: %8.1f us\n", "premultiply_argb", measure(premultiply_argb, result, src, len));
+
+    free(src);
+    free(reference);
+    free(old);
+    free(result);
+
+    return failed;
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -125,6 +125,21 @@ table.insert(steps, function()
     return client.focus == c1
 end)
 
+-- Each read of the icon is a copy, so that modifying it does not change the
+-- icons of other clients which share it
+table.insert(steps, function()
+    local cairo = require("lgi").cairo
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, 16, 16)
+    c1.icon = img._native
+    local icon1, icon2 = c1.icon, c1.icon
+    assert(icon1 and icon2 and icon1 ~= icon2)
+    -- Take ownership of the copies
+    cairo.Surface(icon1, true)
+    cairo.Surface(icon2, true)
+
+    return true
+end)
+
 local has_error
 
 -- Disable awful.screen.preferred(c)
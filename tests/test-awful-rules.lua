@@ -286,6 +286,57 @@ test_rule {
     end
 }
 
+-- The compiled matcher has to agree with awful.rules.matches
+local function check_matching_rules()
+    local rule_list = {
+        { rule = { class = "rule" } },
+        { rule = { class = "^rule%d+$", name = "Foo" } },
+        { rule_any = { class = { "nothing", "^rule0000000042$" } } },
+        { rule_any = { name = { "Fo" }, class = { "[r]ule" } } },
+        { rule = {}, except = { class = "rule" } },
+        { rule = { class = "rule" }, except_any = { name = { "^Foo$" } } },
+        { rule = { name = "Foo", class = "nothing" } },
+        { rule_any = { class = { "^rule$" } } },
+    }
+    for _, c in ipairs(client.get()) do
+        local expected = {}
+        for _, entry in ipairs(rule_list) do
+            if awful.rules.matches(c, entry) then
+                table.insert(expected, entry)
+            end
+        end
+        local result = awful.rules.matching_rules(c, rule_list)
+        assert(#result == #expected)
+        for i, entry in ipairs(expected) do
+            assert(result[i] == entry)
+        end
+        assert(awful.rules.matches_list(c, rule_list) == (#expected > 0))
+    end
+
+    -- Appending to the list is noticed, other changes after invalidating
+    local c = client.get()[1]
+    local count = #awful.rules.matching_rules(c, rule_list)
+    table.insert(rule_list, { rule = { class = c.class } })
+    assert(#awful.rules.matching_rules(c, rule_list) == count + 1)
+    rule_list[#rule_list].rule = { class = "nothing" }
+    awful.rules.invalidate()
+    assert(#awful.rules.matching_rules(c, rule_list) == count)
+
+    -- Changing an entry in place
+    rule_list[#rule_list].rule.class = c.class
+    awful.rules.invalidate()
+    assert(#awful.rules.matching_rules(c, rule_list) == count + 1)
+    rule_list[#rule_list].rule_any = { class = { "nothing" } }
+    rule_list[#rule_list].rule = nil
+    awful.rules.invalidate()
+    assert(#awful.rules.matching_rules(c, rule_list) == count)
+    rule_list[#rule_list].rule_any.class[2] = c.class
+    awful.rules.invalidate()
+    assert(#awful.rules.matching_rules(c, rule_list) == count + 1)
+
+    return true
+end
+
 -- Wait until all the auto-generated clients are ready
 local function spawn_clients()
     if #client.get() >= #tests then
@@ -295,6 +346,8 @@ local function spawn_clients()
     end
 end
 
-require("_runner").run_steps{spawn_clients, unpack(tests)}
+local steps = { spawn_clients, unpack(tests) }
+table.insert(steps, check_matching_rules)
+require("_runner").run_steps(steps)
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -3,8 +3,13 @@
 
 local runner = require("_runner")
 local awful = require("awful")
+local wibox = require("wibox")
+local matrix = require("gears.matrix")
 local GLib = require("lgi").GLib
+local cairo = require("lgi").cairo
 local create_wibox = require("_wibox_helper").create_wibox
+local test_client = require("_client")
+local unpack = unpack or table.unpack -- luacheck: globals unpack (compatibility with Lua 5.1)
 
 local BENCHMARK_EXACT = os.getenv("BENCHMARK_EXACT")
 if not BENCHMARK_EXACT then
@@ -34,8 +39,19 @@ do
             iters = math.ceil(target_time / time_per_iter)
             time_per_iter, time_total = measure(f, iters)
         end
-        print(string.format("%20s: %-10.6g sec/iter (%3d iters, %.4g sec for benchmark)",
-                            msg, time_per_iter, iters, timer_benchmark:elapsed()))
+        local elapsed = timer_benchmark:elapsed()
+
+        -- How much garbage does a single iteration produce?
+        collectgarbage("collect")
+        collectgarbage("stop")
+        local memory, matrices = collectgarbage("count"), matrix.get_allocations()
+        f()
+        memory, matrices = collectgarbage("count") - memory, matrix.get_allocations() - matrices
+        collectgarbage("restart")
+
+        print(string.format("%20s: %-10.6g sec/iter (%3d iters, %.4g sec for benchmark, "
+                            .. "%.1f KiB and %d matrices allocated per iter)",
+                            msg, time_per_iter, iters, elapsed, memory, matrices))
     end
 end
 
@@ -48,13 +64,30 @@ local function create_and_draw_wibox()
     do_pending_repaint()
 end
 
-local _, textclock = create_wibox()
+local wb, textclock = create_wibox()
 
 local function relayout_textclock()
     textclock:emit_signal("widget::layout_changed")
     do_pending_repaint()
 end
 
+-- A wide layout like a tasklist with many clients
+local relayout_tasklist_entry
+do
+    local layout = wibox.layout.fixed.horizontal()
+    local entries = {}
+    for i = 1, 200 do
+        entries[i] = wibox.widget.textbox("client " .. i)
+        layout:add(entries[i])
+    end
+    local tasklist_wb = wibox({ width = 1024, height = 20, screen = 1 })
+    tasklist_wb:set_widget(layout)
+    relayout_tasklist_entry = function()
+        entries[100]:emit_signal("widget::layout_changed")
+        do_pending_repaint()
+    end
+end
+
 local function redraw_textclock()
     textclock:emit_signal("widget::redraw_needed")
     do_pending_repaint()
@@ -65,6 +98,92 @@ local function update_textclock()
     do_pending_repaint()
 end
 
+local function emit_signal_from_lua()
+    wb.drawin:emit_signal("property::geometry")
+end
+
+local function emit_signal_from_c()
+    -- Moving a drawin emits property::geometry, ::x and ::y from C
+    wb.drawin.x = wb.drawin.x == 0 and 1 or 0
+end
+
+local emit_signal_many_handlers
+do
+    local handlers, args = 20, 4
+    for _ = 1, handlers do
+        wb.drawin:connect_signal("benchmark::handlers", function() end)
+    end
+    local values = {}
+    for i = 1, args do
+        values[i] = i
+    end
+    emit_signal_many_handlers = function()
+        wb.drawin:emit_signal("benchmark::handlers", unpack(values))
+    end
+end
+
+-- A large, translucent icon, as published by browsers
+local icon_path = os.tmpname()
+do
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, 256, 256)
+    local cr = cairo.Context(img)
+    cr:set_source_rgba(1, 0.5, 0, 0.5)
+    cr:paint()
+    img:write_to_png(icon_path)
+end
+
+local function load_icon()
+    awesome.load_image(icon_path)
+end
+
+-- A large rule set, matched against real clients as if 500 clients were
+-- managed
+local rule_clients_count = 20
+local spawn_rule_clients, match_rules, match_rules_uncompiled
+do
+    local names = { "Firefox", "URxvt", "Gimp", "Pidgin", "mpv", "Steam", "Emacs", "Thunderbird" }
+    local big_rules = {}
+    for i = 1, 300 do
+        local name = names[i % #names + 1]
+        if i % 3 == 0 then
+            table.insert(big_rules, { rule = { class = name .. i }, properties = { floating = true } })
+        elseif i % 3 == 1 then
+            table.insert(big_rules, { rule = { instance = name:lower(), type = "dialog" },
+                                      except = { role = "^browser%-" .. i .. "$" } })
+        else
+            table.insert(big_rules, { rule_any = { class = { name .. i, "^App" .. i .. "$" },
+                                                   name = { "Window " .. i } } })
+        end
+    end
+    spawn_rule_clients = function()
+        for i = 1, rule_clients_count do
+            test_client(names[i % #names + 1] .. i * 15, "Window " .. i * 15)
+        end
+    end
+    local function foreach_client(f)
+        local clients = client.get()
+        for i = 1, 500 do
+            f(clients[i % #clients + 1])
+        end
+    end
+    match_rules = function()
+        foreach_client(function(c)
+            awful.rules.matching_rules(c, big_rules)
+        end)
+    end
+    -- What awful.rules.matching_rules did before rule lists were compiled
+    match_rules_uncompiled = function()
+        foreach_client(function(c)
+            local result = {}
+            for _, entry in ipairs(big_rules) do
+                if awful.rules.matches(c, entry) then
+                    table.insert(result, entry)
+                end
+            end
+        end)
+    end
+end
+
 local function e2e_tag_switch()
     awful.tag.viewnext()
     do_pending_repaint()
@@ -73,9 +192,59 @@ end
 benchmark(create_and_draw_wibox, "create&draw wibox")
 benchmark(update_textclock, "update textclock")
 benchmark(relayout_textclock, "relayout textclock")
+benchmark(relayout_tasklist_entry, "relayout 200 entries")
 benchmark(redraw_textclock, "redraw textclock")
+benchmark(emit_signal_from_lua, "emit signal from Lua")
+benchmark(emit_signal_from_c, "emit signal from C")
+benchmark(emit_signal_many_handlers, "emit to 20 handlers")
+benchmark(load_icon, "load 256x256 icon")
 benchmark(e2e_tag_switch, "tag switch")
 
-runner.run_steps({ function() return true end })
+os.remove(icon_path)
+
+-- Where did the main loop spend its time since the statistics were reset?
+local function print_stats()
+    local all_stats = awesome.stats()
+    for _, phase in ipairs { "x_events", "glib_dispatch", "screen_refresh",
+            "lua_refresh", "drawin_refresh", "client_refresh", "banning_refresh",
+            "stack_refresh", "destroy_later", "lua_callbacks", "iteration" } do
+        local stats = all_stats[phase]
+        local mean = stats.count > 0 and stats.total / stats.count or 0
+        print(string.format("%20s: %-10.6g sec/iter mean, %-10.6g sec max (%d runs)",
+                            phase, mean, stats.max, stats.count))
+    end
+end
+
+-- How many main loop iterations switch tags in the end-to-end step. The
+-- runner gives up on a step after five iterations without a result.
+local tag_switch_iterations = 4
+
+runner.run_steps({
+    -- The rule benchmarks need real clients
+    function(count)
+        if count == 1 then
+            spawn_rule_clients()
+        end
+        if #client.get() >= rule_clients_count then
+            benchmark(match_rules, "match 300 rules x500")
+            benchmark(match_rules_uncompiled, "uncompiled rules")
+            return true
+        end
+    end,
+
+    -- Switch tags with the clients visible, once per main loop iteration, and
+    -- look at the main loop statistics of only that
+    function(count)
+        if count == 1 then
+            awesome.stats(true)
+        end
+        if count <= tag_switch_iterations then
+            awful.tag.viewnext()
+            return
+        end
+        print_stats()
+        return true
+    end,
+})
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,122 @@
+--- Tests for awesome.load_image_async
+
+local runner = require("_runner")
+local gears = require("gears")
+local cairo = require("lgi").cairo
+
+local function write_image(width, height)
+    local path = os.tmpname()
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, width, height)
+    local cr = cairo.Context(img)
+    cr:set_source_rgba(1, 0, 0, 0.5)
+    cr:paint()
+    img:write_to_png(path)
+    return path
+end
+
+local path = write_image(40, 20)
+
+local results, raw_results = {}, {}
+local error_message
+local decodes = awesome.stats().async_image_decodes
+
+local steps = {
+    function(count)
+        if count == 1 then
+            -- The first two are coalesced, the third has a different size
+            for i = 1, 3 do
+                awesome.load_image_async(path, i == 3 and 10 or nil, function(surf, err)
+                    assert(not err, err)
+                    raw_results[i] = surf
+                    results[i] = cairo.Surface(surf, true)
+                end)
+            end
+            awesome.load_image_async("/this/does/not/exist.png", nil, function(surf, err)
+                assert(surf == nil)
+                error_message = err
+            end)
+            -- Nothing was loaded synchronously
+            assert(#results == 0 and not error_message)
+        end
+        return results[1] and results[2] and results[3] and error_message and true
+    end,
+
+    function()
+        assert(gears.surface.get_size(results[1]) == 40)
+        assert(gears.surface.get_size(results[2]) == 40)
+        local w, h = gears.surface.get_size(results[3])
+        assert(w == 10 and h == 5, w .. "x" .. h)
+        assert(error_message ~= "")
+        -- The coalesced loads got the same surface
+        assert(raw_results[1] == raw_results[2])
+        assert(raw_results[1] ~= raw_results[3])
+        assert(awesome.stats().async_image_decodes - decodes == 3)
+        return true
+    end,
+}
+
+local loaded_async
+table.insert(steps, function(count)
+    if count == 1 then
+        gears.surface.load_async(path, function(surf)
+            loaded_async = surf
+        end)
+    end
+    if not loaded_async then
+        return
+    end
+    -- A second load is answered from the cache
+    local cached
+    gears.surface.load_async(path, function(surf)
+        cached = surf
+    end)
+    assert(cached == loaded_async)
+    assert(gears.surface.load(path) == loaded_async)
+    os.remove(path)
+    return true
+end)
+
+-- Loads of the same file that overlap decode it once
+local other_path = write_image(30, 30)
+local first, second, missing_error
+table.insert(steps, function(count)
+    if count == 1 then
+        decodes = awesome.stats().async_image_decodes
+        gears.surface.load_async(other_path, function(surf, err)
+            assert(not err, err)
+            first = surf
+        end)
+        gears.surface.load_async(other_path, function(surf, err)
+            assert(not err, err)
+            second = surf
+        end)
+        assert(not first and not second)
+    end
+    if not first or not second then
+        return
+    end
+    assert(first == second)
+    assert(gears.surface.get_size(first) == 30)
+    assert(awesome.stats().async_image_decodes - decodes == 1)
+    os.remove(other_path)
+    return true
+end)
+
+-- A missing file is reported to the callback
+table.insert(steps, function(count)
+    if count == 1 then
+        gears.surface.load_async("/this/does/not/exist.png", function(surf, err)
+            assert(surf == nil)
+            missing_error = err
+        end)
+    end
+    if not missing_error then
+        return
+    end
+    assert(type(missing_error) == "string" and missing_error ~= "", missing_error)
+    return true
+end)
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,116 @@
+--- Tests for the cache of parsed .desktop files in menubar.utils
+
+local runner = require("_runner")
+local utils = require("menubar.utils")
+
+local dir = os.tmpname()
+os.remove(dir)
+os.execute("mkdir -p " .. dir .. "/sub")
+utils.desktop_cache_file = dir .. ".cache"
+
+-- Outside of the directory, so that it is not parsed as a .desktop file
+local icon = dir .. ".png"
+
+local function write_entry(path, name, entry_icon)
+    local f = assert(io.open(path, "w"))
+    f:write("[Desktop Entry]\nName=" .. name .. "\nExec=" .. name .. "\nCategories=Game;\n")
+    if entry_icon then
+        f:write("Icon=" .. entry_icon .. "\n")
+    end
+    f:close()
+end
+-- The icon does not exist yet
+write_entry(dir .. "/a.desktop", "a", icon)
+write_entry(dir .. "/sub/b.desktop", "b")
+
+-- Count the parsed files
+local parsed = 0
+local real_lines = io.lines
+io.lines = function(...)
+    parsed = parsed + 1
+    return real_lines(...)
+end
+
+local result, icon_paths
+local function parse()
+    result = nil
+    utils.parse_dir(dir, function(programs)
+        local names = {}
+        icon_paths = {}
+        for _, program in ipairs(programs) do
+            table.insert(names, program.Name)
+            icon_paths[program.Name] = program.icon_path
+        end
+        table.sort(names)
+        result = table.concat(names, ",")
+    end)
+end
+
+local steps = {
+    function(count)
+        if count == 1 then
+            parse()
+        end
+        if result then
+            assert(result == "a,b", result)
+            assert(parsed == 2, parsed)
+            assert(icon_paths.a == nil, icon_paths.a)
+            return true
+        end
+    end,
+
+    -- Nothing changed, so nothing is parsed
+    function(count)
+        if count == 1 then
+            parse()
+            assert(not result)
+        end
+        if result then
+            assert(result == "a,b", result)
+            assert(parsed == 2, parsed)
+            return true
+        end
+    end,
+
+    -- Only the new file is parsed once the file monitor noticed it. Until
+    -- then, the cached result is returned, so scan again after each result.
+    function(count)
+        if count == 1 then
+            write_entry(dir .. "/sub/c.desktop", "c")
+        end
+        if result == "a,b,c" then
+            assert(parsed == 3, parsed)
+            return true
+        end
+        if result then
+            assert(result == "a,b", result)
+            assert(parsed == 2, parsed)
+            parse()
+        end
+    end,
+
+    -- The cache file is used by a new instance of the module. The icon that
+    -- was not found before is looked up again.
+    function(count)
+        if count == 1 then
+            local f = assert(io.open(icon, "w"))
+            f:close()
+            package.loaded["menubar.utils"] = nil
+            utils = require("menubar.utils")
+            utils.desktop_cache_file = dir .. ".cache"
+            parse()
+        end
+        if result then
+            assert(result == "a,b,c", result)
+            assert(parsed == 3, parsed)
+            assert(icon_paths.a == icon, icon_paths.a)
+            io.lines = real_lines
+            os.execute("rm -rf " .. dir .. " " .. dir .. ".cache " .. icon)
+            return true
+        end
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
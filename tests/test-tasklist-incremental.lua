@@ -0,0 +1,80 @@
+--- Tests for the incremental updates of awful.widget.tasklist
+
+local runner = require("_runner")
+local awful = require("awful")
+local test_client = require("_client")
+
+local tasklist, rebuilds
+
+-- Errors in signal handlers are only reported, so collect them
+local errors = {}
+awesome.connect_signal("debug::error", function(err)
+    table.insert(errors, err)
+end)
+
+-- Does one of the textboxes of the tasklist show the given text?
+local function shows(text)
+    for _, w in ipairs(tasklist:get_all_children()) do
+        if w.get_markup and (w:get_markup() or ""):find(text, 1, true) then
+            return true
+        end
+    end
+    return false
+end
+
+local steps = {
+    function(count)
+        if count == 1 then
+            tasklist = awful.widget.tasklist(screen[1], awful.widget.tasklist.filter.alltags)
+            rebuilds = 0
+            local reset = tasklist.reset
+            tasklist.reset = function(...)
+                rebuilds = rebuilds + 1
+                return reset(...)
+            end
+            test_client("tasklist_incremental", "first title")
+        end
+        if #client.get() >= 1 and shows("first title") then
+            return true
+        end
+    end,
+
+    -- A new title only updates the entry of the client
+    function(count)
+        if count == 1 then
+            rebuilds = 0
+            client.get()[1].name = "second title"
+        end
+        if shows("second title") then
+            assert(rebuilds == 0, rebuilds)
+            assert(not shows("first title"))
+            return true
+        end
+    end,
+
+    -- A client that disappears from the tasklist rebuilds it
+    function(count)
+        if count == 1 then
+            client.get()[1].skip_taskbar = true
+        end
+        if not shows("second title") then
+            assert(rebuilds == 1, rebuilds)
+            return true
+        end
+    end,
+
+    -- Closing the client must not break the unmanage handler
+    function(count)
+        if count == 1 then
+            client.get()[1]:kill()
+        end
+        if #client.get() == 0 then
+            assert(#errors == 0, errors[1])
+            return true
+        end
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80